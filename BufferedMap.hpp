@@ -0,0 +1,238 @@
+#ifndef BUFFERED_MAP_HPP
+#define BUFFERED_MAP_HPP
+
+#include "Tree.hpp"
+#include <optional>
+#include <utility>
+
+enum class MergePolicy { Auto, Hinted, Rebuild };
+
+template <class Key, class T, class Compare = std::less<Key>>
+class BufferedMap {
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare = Compare;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+
+private:
+  struct SelectFirst {
+    const Key& operator()(const_reference p) {
+      return p.first;
+    }
+  };
+
+  using Tree = RbTree<Key, value_type, SelectFirst, Compare, true>;
+  using node_pointer = Tree::node_pointer;
+
+  struct Write {
+    Key key;
+    std::optional<T> mapped;
+    bool overwrite;
+  };
+
+  enum class State { Keep, Absent, Written };
+
+  struct Outcome {
+    State state;
+    Write* write;
+  };
+
+  mutable Tree tree;
+  mutable std::vector<Write> buffer;
+  std::size_t capacity;
+  MergePolicy policy;
+
+public:
+  using iterator = Tree::const_iterator;
+  using const_iterator = Tree::const_iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  static Outcome fold(bool present, Write* first, Write* last) {
+    Outcome out{present ? State::Keep : State::Absent, nullptr};
+    for (; first != last; ++first)
+      if (!first->mapped)
+        out = {State::Absent, nullptr};
+      else if (first->overwrite || out.state == State::Absent)
+        out = {State::Written, first};
+    return out;
+  }
+
+  Write* group_end(Write* first, Write* last) const {
+    const Compare comp = tree.key_comp();
+    Write* next = first + 1;
+    while (next != last && !comp(first->key, next->key))
+      ++next;
+    return next;
+  }
+
+  void merge_hinted(Write* first, Write* last) const {
+    const Compare comp = tree.key_comp();
+    while (first != last) {
+      Write* const next = group_end(first, last);
+      auto pos = tree.lower_bound(first->key);
+      const bool present = pos != tree.end() && !comp(first->key, pos->first);
+      const Outcome out = fold(present, first, next);
+      if (out.state == State::Absent && present)
+        tree.erase(pos);
+      else if (out.state == State::Written && present)
+        pos->second = std::move(*out.write->mapped);
+      else if (out.state == State::Written)
+        tree.insert_hint(pos, value_type(std::move(out.write->key),
+                                         std::move(*out.write->mapped)));
+      first = next;
+    }
+  }
+
+  void merge_rebuild(Write* first, Write* last) const {
+    const Compare comp = tree.key_comp();
+    const std::vector<node_pointer> old = tree.release_nodes();
+    std::vector<node_pointer> nodes;
+    nodes.reserve(old.size() + (last - first));
+    auto it = old.begin();
+    while (first != last) {
+      Write* const next = group_end(first, last);
+      while (it != old.end() && comp((*it)->val.first, first->key))
+        nodes.push_back(*it++);
+      const bool present =
+          it != old.end() && !comp(first->key, (*it)->val.first);
+      const Outcome out = fold(present, first, next);
+      if (out.state == State::Absent && present)
+        Tree::drop_node(*it++);
+      else if (out.state == State::Written && present) {
+        (*it)->val.second = std::move(*out.write->mapped);
+        nodes.push_back(*it++);
+      } else if (out.state == State::Written)
+        nodes.push_back(Tree::make_node(
+            nullptr, value_type(std::move(out.write->key),
+                                std::move(*out.write->mapped))));
+      first = next;
+    }
+    nodes.insert(nodes.end(), it, old.end());
+    tree.link_nodes(nodes);
+  }
+
+  bool rebuilds() const {
+    return policy == MergePolicy::Rebuild ||
+           (policy == MergePolicy::Auto && buffer.size() * 16 >= tree.size());
+  }
+
+  void push(Write&& w) {
+    buffer.push_back(std::move(w));
+    if (buffer.size() >= capacity)
+      flush();
+  }
+
+public:
+  explicit BufferedMap(std::size_t buffer_size = 65536,
+                       MergePolicy merge = MergePolicy::Auto,
+                       const Compare& comp = Compare()) :
+      tree(comp), capacity(std::max<std::size_t>(buffer_size, 1)),
+      policy(merge) {
+    buffer.reserve(capacity);
+  }
+
+  void flush() const {
+    if (buffer.empty())
+      return;
+    const Compare comp = tree.key_comp();
+    std::stable_sort(
+        buffer.begin(), buffer.end(),
+        [&](const Write& a, const Write& b) { return comp(a.key, b.key); });
+    if (rebuilds())
+      merge_rebuild(buffer.data(), buffer.data() + buffer.size());
+    else
+      merge_hinted(buffer.data(), buffer.data() + buffer.size());
+    buffer.clear();
+  }
+
+  void insert(const value_type& value) {
+    push({value.first, value.second, false});
+  }
+  void insert(value_type&& value) {
+    push({value.first, std::move(value.second), false});
+  }
+  template <class M>
+  void insert_or_assign(const key_type& key, M&& obj) {
+    push({key, std::forward<M>(obj), true});
+  }
+  template <class M>
+  void insert_or_assign(key_type&& key, M&& obj) {
+    push({std::move(key), std::forward<M>(obj), true});
+  }
+  void erase(const key_type& key) {
+    push({key, std::nullopt, true});
+  }
+  void clear() {
+    buffer.clear();
+    tree.clear();
+  }
+  size_type buffered() const {
+    return buffer.size();
+  }
+  size_type buffer_capacity() const {
+    return capacity;
+  }
+  MergePolicy merge_policy() const {
+    return policy;
+  }
+
+  const_iterator begin() const {
+    flush();
+    return tree.begin();
+  }
+  const_iterator end() const {
+    flush();
+    return tree.end();
+  }
+  const_reverse_iterator rbegin() const {
+    return std::reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return std::reverse_iterator(begin());
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+  size_type size() const {
+    flush();
+    return tree.size();
+  }
+  bool verify() const {
+    flush();
+    return tree.verify();
+  }
+  const mapped_type& at(const key_type& key) const {
+    return find(key)->second;
+  }
+  const_iterator find(const key_type& key) const {
+    flush();
+    return tree.find(key);
+  }
+  size_type count(const key_type& key) const {
+    flush();
+    return tree.count(key);
+  }
+  bool contains(const key_type& key) const {
+    return find(key) != tree.end();
+  }
+  const_iterator lower_bound(const key_type& key) const {
+    flush();
+    return tree.lower_bound(key);
+  }
+  const_iterator upper_bound(const key_type& key) const {
+    flush();
+    return tree.upper_bound(key);
+  }
+  key_compare key_comp() const {
+    return tree.key_comp();
+  }
+};
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef COMPRESSED_MULTI_MAP_HPP
+#define COMPRESSED_MULTI_MAP_HPP
+
+#include "Tree.hpp"
+#include <span>
+#include <utility>
+
+template <class Key, class T, class Compare = std::less<Key>>
+class CompressedMultiMap {
+  using Bucket = std::vector<T>;
+  using Entry = std::pair<const Key, Bucket>;
+
+  struct SelectFirst {
+    const Key& operator()(const Entry& e) const {
+      return e.first;
+    }
+  };
+
+  using Tree = RbTree<Key, Entry, SelectFirst, Compare, true>;
+  using TreeIterator = Tree::iterator;
+  Tree tree;
+  std::size_t count_ = 0;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare = Compare;
+
+  template <bool Const>
+  class Iterator {
+    friend class CompressedMultiMap;
+
+    TreeIterator it;
+    std::size_t index = 0;
+
+    Iterator(NodeBase* node, std::size_t i) : it(node), index(i) {}
+
+  public:
+    using value_type = CompressedMultiMap::value_type;
+    using reference =
+        std::pair<const Key&, std::conditional_t<Const, const T&, T&>>;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    struct pointer {
+      reference ref;
+
+      const reference* operator->() const {
+        return &ref;
+      }
+    };
+
+    Iterator() = default;
+    Iterator(const Iterator&) = default;
+    Iterator& operator=(const Iterator&) = default;
+    Iterator(const Iterator<false>& other)
+    requires Const
+        : it(other.it), index(other.index) {}
+
+    reference operator*() const {
+      return {it->first, it->second[index]};
+    }
+
+    pointer operator->() const {
+      return {**this};
+    }
+
+    Iterator& operator++() {
+      if (++index == it->second.size()) {
+        ++it;
+        index = 0;
+      }
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      Iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    Iterator& operator--() {
+      if (index == 0) {
+        --it;
+        index = it->second.size();
+      }
+      --index;
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      Iterator tmp(*this);
+      --*this;
+      return tmp;
+    }
+
+    bool operator==(const Iterator&) const = default;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reference = iterator::reference;
+  using const_reference = const_iterator::reference;
+
+private:
+  static iterator first_of(auto position) {
+    return iterator(position.node, 0);
+  }
+
+  template <class K, class... Args>
+  iterator emplace_key(K&& key, Args&&... args) {
+    TreeIterator pos = tree.lower_bound(key);
+    if (pos == tree.end() || key_comp()(key, pos->first)) {
+      // The bucket is filled before it is linked, so a throwing value
+      // constructor cannot leave an empty bucket in the tree.
+      Bucket bucket;
+      bucket.emplace_back(std::forward<Args>(args)...);
+      pos = tree.insert_hint(pos,
+                             Entry(std::forward<K>(key), std::move(bucket)));
+    } else
+      pos->second.emplace_back(std::forward<Args>(args)...);
+    ++count_;
+    return iterator(pos.node, pos->second.size() - 1);
+  }
+
+public:
+  CompressedMultiMap() = default;
+  explicit CompressedMultiMap(const Compare& comp) : tree(comp) {}
+  template <class InputIterator>
+  CompressedMultiMap(InputIterator first, InputIterator last,
+                     const Compare& comp = Compare()) :
+      tree(comp) {
+    insert(first, last);
+  }
+  CompressedMultiMap(std::initializer_list<value_type> init,
+                     const Compare& comp = Compare()) :
+      tree(comp) {
+    insert(init.begin(), init.end());
+  }
+
+  iterator begin() {
+    return first_of(tree.begin());
+  }
+  const_iterator begin() const {
+    return first_of(tree.begin());
+  }
+  iterator end() {
+    return first_of(tree.end());
+  }
+  const_iterator end() const {
+    return first_of(tree.end());
+  }
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  bool empty() const {
+    return count_ == 0;
+  }
+  size_type size() const {
+    return count_;
+  }
+  size_type key_count() const {
+    return tree.size();
+  }
+  bool verify() const {
+    std::size_t n = 0;
+    for (const Entry& e : tree) {
+      if (e.second.empty())
+        return false;
+      n += e.second.size();
+    }
+    return n == count_ && tree.verify();
+  }
+  void clear() {
+    tree.clear();
+    count_ = 0;
+  }
+  iterator insert(const value_type& value) {
+    return emplace_key(value.first, value.second);
+  }
+  iterator insert(value_type&& value) {
+    return emplace_key(value.first, std::move(value.second));
+  }
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    while (first != last)
+      insert(*first++);
+  }
+  template <class... Args>
+  iterator emplace(const key_type& key, Args&&... args) {
+    return emplace_key(key, std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  iterator emplace(key_type&& key, Args&&... args) {
+    return emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+  iterator erase(const_iterator pos) {
+    Bucket& bucket = pos.it->second;
+    bucket.erase(bucket.begin() + pos.index);
+    --count_;
+    if (bucket.empty())
+      return first_of(tree.erase(pos.it));
+    if (pos.index == bucket.size())
+      return first_of(std::next(pos.it));
+    return iterator(pos.it.node, pos.index);
+  }
+  size_type erase(const Key& key) {
+    const TreeIterator pos = tree.find(key);
+    if (pos == tree.end())
+      return 0;
+    const size_type n = pos->second.size();
+    tree.erase(pos);
+    count_ -= n;
+    return n;
+  }
+  std::span<T> values(const Key& key) {
+    const TreeIterator pos = tree.find(key);
+    if (pos == tree.end())
+      return {};
+    return pos->second;
+  }
+  std::span<const T> values(const Key& key) const {
+    const auto pos = tree.find(key);
+    if (pos == tree.end())
+      return {};
+    return pos->second;
+  }
+  size_type count(const Key& key) const {
+    return values(key).size();
+  }
+  bool contains(const Key& key) const {
+    return tree.find(key) != tree.end();
+  }
+  iterator find(const Key& key) {
+    return first_of(tree.find(key));
+  }
+  const_iterator find(const Key& key) const {
+    return first_of(tree.find(key));
+  }
+  iterator lower_bound(const Key& key) {
+    return first_of(tree.lower_bound(key));
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return first_of(tree.lower_bound(key));
+  }
+  iterator upper_bound(const Key& key) {
+    return first_of(tree.upper_bound(key));
+  }
+  const_iterator upper_bound(const Key& key) const {
+    return first_of(tree.upper_bound(key));
+  }
+  std::pair<iterator, iterator> equal_range(const Key& key) {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  key_compare key_comp() const {
+    return tree.key_comp();
+  }
+  friend bool operator==(const CompressedMultiMap& x,
+                         const CompressedMultiMap& y) {
+    return x.count_ == y.count_ && x.tree == y.tree;
+  }
+};
+
+#endif
@@ -0,0 +1,309 @@
+#ifndef INT_SET_HPP
+#define INT_SET_HPP
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+template <std::unsigned_integral Key = std::uint32_t>
+class IntSet {
+  using Word = std::uint64_t;
+  static constexpr std::size_t bits = 64;
+  static constexpr std::size_t npos = std::size_t(-1);
+
+  std::vector<std::vector<Word>> levels{{}};
+  std::size_t count_ = 0;
+
+  std::size_t next_set(std::size_t level, std::size_t i) const {
+    const std::vector<Word>& words = levels[level];
+    std::size_t w = i / bits;
+    if (w >= words.size())
+      return npos;
+    Word m = words[w] & (~Word(0) << (i % bits));
+    if (!m) {
+      if (level + 1 == levels.size())
+        return npos;
+      w = next_set(level + 1, w + 1);
+      if (w == npos)
+        return npos;
+      m = words[w];
+    }
+    return w * bits + std::countr_zero(m);
+  }
+
+  std::size_t prev_set(std::size_t level, std::size_t i) const {
+    const std::vector<Word>& words = levels[level];
+    if (words.empty())
+      return npos;
+    std::size_t w = i / bits;
+    if (w >= words.size()) {
+      w = words.size() - 1;
+      i = w * bits + bits - 1;
+    }
+    Word m = words[w] & (~Word(0) >> (bits - 1 - i % bits));
+    if (!m) {
+      if (level + 1 == levels.size() || w == 0)
+        return npos;
+      w = prev_set(level + 1, w - 1);
+      if (w == npos)
+        return npos;
+      m = words[w];
+    }
+    return w * bits + std::bit_width(m) - 1;
+  }
+
+  bool test(std::size_t i) const {
+    const std::vector<Word>& leaves = levels[0];
+    return i / bits < leaves.size() &&
+           (leaves[i / bits] >> (i % bits) & 1);
+  }
+
+  void set(std::size_t i) {
+    for (std::vector<Word>& words : levels) {
+      Word& w = words[i / bits];
+      const bool had = w != 0;
+      w |= Word(1) << (i % bits);
+      if (had)
+        break;
+      i /= bits;
+    }
+  }
+
+  void reset(std::size_t i) {
+    for (std::vector<Word>& words : levels) {
+      Word& w = words[i / bits];
+      w &= ~(Word(1) << (i % bits));
+      if (w)
+        break;
+      i /= bits;
+    }
+  }
+
+  void summarize() {
+    levels.resize(1);
+    while (levels.back().size() > 1) {
+      const std::vector<Word>& below = levels.back();
+      std::vector<Word> words((below.size() + bits - 1) / bits);
+      for (std::size_t i = 0; i < below.size(); ++i)
+        words[i / bits] |= Word(below[i] != 0) << (i % bits);
+      levels.push_back(std::move(words));
+    }
+  }
+
+  void recount() {
+    count_ = 0;
+    for (Word w : levels[0])
+      count_ += std::popcount(w);
+  }
+
+  void grow(std::size_t i) {
+    // npos marks end(), so it cannot be stored as a key.
+    if (i == npos)
+      throw std::length_error("IntSet: key collides with end()");
+    const std::size_t need = i / bits + 1;
+    if (need <= levels[0].size())
+      return;
+    levels[0].resize(std::max(need, 2 * levels[0].size()));
+    summarize();
+  }
+
+public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare = std::less<Key>;
+
+  class const_iterator {
+    friend class IntSet;
+
+    const IntSet* set = nullptr;
+    std::size_t pos = npos;
+
+    const_iterator(const IntSet* s, std::size_t p) : set(s), pos(p) {}
+
+  public:
+    using value_type = Key;
+    using reference = Key;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    const_iterator() = default;
+
+    reference operator*() const {
+      return Key(pos);
+    }
+
+    const_iterator& operator++() {
+      pos = set->next_set(0, pos + 1);
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    const_iterator& operator--() {
+      pos = set->prev_set(0, pos == npos ? npos - 1 : pos - 1);
+      return *this;
+    }
+
+    const_iterator operator--(int) {
+      const_iterator tmp(*this);
+      --*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return pos == other.pos;
+    }
+  };
+
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  IntSet() = default;
+  IntSet(std::initializer_list<Key> init) {
+    for (Key k : init)
+      insert(k);
+  }
+  template <class InputIterator>
+  IntSet(InputIterator first, InputIterator last) {
+    while (first != last)
+      insert(*first++);
+  }
+
+  const_iterator begin() const {
+    return {this, next_set(0, 0)};
+  }
+  const_iterator end() const {
+    return {this, npos};
+  }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  bool empty() const {
+    return count_ == 0;
+  }
+  size_type size() const {
+    return count_;
+  }
+  size_type universe() const {
+    return levels[0].size() * bits;
+  }
+  void clear() {
+    levels = {{}};
+    count_ = 0;
+  }
+  void reserve(Key max_key) {
+    grow(max_key);
+  }
+  std::pair<iterator, bool> insert(Key key) {
+    grow(key);
+    const bool inserted = !test(key);
+    if (inserted) {
+      set(key);
+      ++count_;
+    }
+    return {{this, key}, inserted};
+  }
+  template <class InputIterator>
+  void insert(InputIterator first, InputIterator last) {
+    while (first != last)
+      insert(*first++);
+  }
+  size_type erase(Key key) {
+    if (!test(key))
+      return 0;
+    reset(key);
+    --count_;
+    return 1;
+  }
+  iterator erase(const_iterator pos) {
+    const const_iterator next = std::next(pos);
+    erase(*pos);
+    return next;
+  }
+  const_iterator find(Key key) const {
+    return test(key) ? const_iterator(this, key) : end();
+  }
+  size_type count(Key key) const {
+    return test(key);
+  }
+  bool contains(Key key) const {
+    return test(key);
+  }
+  const_iterator lower_bound(Key key) const {
+    return {this, next_set(0, key)};
+  }
+  const_iterator upper_bound(Key key) const {
+    if (std::size_t(key) == npos)
+      return end();
+    return {this, next_set(0, std::size_t(key) + 1)};
+  }
+  std::pair<const_iterator, const_iterator> equal_range(Key key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  key_compare key_comp() const {
+    return key_compare();
+  }
+
+  IntSet& operator|=(const IntSet& other) {
+    const std::vector<Word>& rhs = other.levels[0];
+    std::vector<Word>& lhs = levels[0];
+    if (lhs.size() < rhs.size())
+      lhs.resize(rhs.size());
+    for (std::size_t i = 0; i < rhs.size(); ++i)
+      lhs[i] |= rhs[i];
+    summarize();
+    recount();
+    return *this;
+  }
+  IntSet& operator&=(const IntSet& other) {
+    const std::vector<Word>& rhs = other.levels[0];
+    std::vector<Word>& lhs = levels[0];
+    if (lhs.size() > rhs.size())
+      lhs.resize(rhs.size());
+    for (std::size_t i = 0; i < lhs.size(); ++i)
+      lhs[i] &= rhs[i];
+    summarize();
+    recount();
+    return *this;
+  }
+  IntSet& operator-=(const IntSet& other) {
+    const std::vector<Word>& rhs = other.levels[0];
+    std::vector<Word>& lhs = levels[0];
+    for (std::size_t i = 0, n = std::min(lhs.size(), rhs.size()); i < n; ++i)
+      lhs[i] &= ~rhs[i];
+    summarize();
+    recount();
+    return *this;
+  }
+  friend IntSet operator|(IntSet lhs, const IntSet& rhs) {
+    return lhs |= rhs;
+  }
+  friend IntSet operator&(IntSet lhs, const IntSet& rhs) {
+    return lhs &= rhs;
+  }
+  friend IntSet operator-(IntSet lhs, const IntSet& rhs) {
+    return lhs -= rhs;
+  }
+  friend bool operator==(const IntSet& x, const IntSet& y) {
+    return x.count_ == y.count_ && std::equal(x.begin(), x.end(), y.begin());
+  }
+};
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef INTERVAL_MAP_HPP
+#define INTERVAL_MAP_HPP
+
+#include "Tree.hpp"
+#include <optional>
+#include <type_traits>
+
+template <class Key>
+struct Interval {
+  Key start;
+  Key end;
+
+  bool operator==(const Interval&) const = default;
+};
+
+template <class Key, class T, class Compare = std::less<Key>>
+class IntervalMap {
+public:
+  using key_type = Key;
+  using interval_type = Interval<Key>;
+  using mapped_type = T;
+  using value_type = std::pair<const interval_type, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare = Compare;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+
+private:
+  static_assert(std::is_empty_v<Compare>,
+                "IntervalMap's max-end summary needs a stateless comparator");
+
+  struct SelectStart {
+    const Key& operator()(const_reference p) {
+      return p.first.start;
+    }
+  };
+
+  struct MaxEnd {
+    using value_type = std::optional<Key>;
+
+    static value_type identity() {
+      return std::nullopt;
+    }
+
+    static value_type lift(const_reference p) {
+      return p.first.end;
+    }
+
+    static value_type combine(const value_type& lhs, const value_type& rhs) {
+      if (!lhs)
+        return rhs;
+      if (!rhs)
+        return lhs;
+      return Compare()(*lhs, *rhs) ? rhs : lhs;
+    }
+  };
+
+  using Tree = RbTree<Key, value_type, SelectStart, Compare, false, MaxEnd>;
+  Tree tree;
+
+public:
+  using iterator = Tree::iterator;
+  using const_iterator = Tree::const_iterator;
+
+  class overlap_iterator {
+    friend class IntervalMap;
+
+    const Tree* tree;
+    const_iterator it;
+    Key lo;
+    Key hi;
+    bool closed;
+
+    overlap_iterator(const Tree* t, const_iterator i, const Key& lo,
+                     const Key& hi, bool closed) :
+        tree(t), it(i), lo(lo), hi(hi), closed(closed) {}
+
+    // The max-end summary prunes subtrees ending at or before lo, and the
+    // walk stops at the first start past hi.
+    auto summary_after_lo() const {
+      return [this](const MaxEnd::value_type& end) {
+        return end && tree->key_comp()(lo, *end);
+      };
+    }
+
+    auto ends_after_lo() const {
+      return [this](const_reference p) {
+        return tree->key_comp()(lo, p.first.end);
+      };
+    }
+
+    auto starts_after_hi() const {
+      return [this](const_reference p) {
+        const Key& start = p.first.start;
+        return closed ? tree->key_comp()(hi, start)
+                      : !tree->key_comp()(start, hi);
+      };
+    }
+
+  public:
+    using value_type = const IntervalMap::value_type;
+    using reference = value_type&;
+    using pointer = value_type*;
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    overlap_iterator() = default;
+
+    reference operator*() const {
+      return *it;
+    }
+
+    pointer operator->() const {
+      return &*it;
+    }
+
+    overlap_iterator& operator++() {
+      it = tree->find_next(it, summary_after_lo(), ends_after_lo(),
+                           starts_after_hi());
+      return *this;
+    }
+
+    overlap_iterator operator++(int) {
+      overlap_iterator tmp(*this);
+      ++*this;
+      return tmp;
+    }
+
+    const_iterator base() const {
+      return it;
+    }
+
+    bool operator==(const overlap_iterator& other) const {
+      return it == other.it;
+    }
+  };
+
+  struct overlap_range {
+    overlap_iterator first;
+    overlap_iterator last;
+
+    overlap_iterator begin() const {
+      return first;
+    }
+
+    overlap_iterator end() const {
+      return last;
+    }
+
+    bool empty() const {
+      return first == last;
+    }
+  };
+
+private:
+  overlap_range query(const Key& lo, const Key& hi, bool closed) const {
+    const overlap_iterator last(&tree, tree.end(), lo, hi, closed);
+    overlap_iterator first = last;
+    first.it = tree.find_first(first.summary_after_lo(), first.ends_after_lo(),
+                               first.starts_after_hi());
+    return {first, last};
+  }
+
+public:
+  IntervalMap() = default;
+  ~IntervalMap() = default;
+  IntervalMap(const IntervalMap&) = default;
+  IntervalMap(IntervalMap&&) = default;
+  IntervalMap& operator=(const IntervalMap&) = default;
+  IntervalMap& operator=(IntervalMap&&) = default;
+
+  explicit IntervalMap(const Compare& comp) : tree(comp) {}
+  IntervalMap(std::initializer_list<value_type> init,
+              const Compare& comp = Compare()) :
+      tree(comp) {
+    for (auto&& e : init)
+      tree.insert(e);
+  }
+
+  iterator begin() {
+    return tree.begin();
+  }
+  const_iterator begin() const {
+    return tree.begin();
+  }
+  iterator end() {
+    return tree.end();
+  }
+  const_iterator end() const {
+    return tree.end();
+  }
+  bool empty() const {
+    return tree.size() == 0;
+  }
+  size_type size() const {
+    return tree.size();
+  }
+  bool verify() const {
+    return tree.verify();
+  }
+  void clear() {
+    tree.clear();
+  }
+  iterator insert(const value_type& value) {
+    return tree.insert(value);
+  }
+  iterator insert(value_type&& value) {
+    return tree.insert(std::move(value));
+  }
+  iterator insert(const interval_type& interval, const mapped_type& mapped) {
+    return tree.insert(value_type(interval, mapped));
+  }
+  iterator erase(const_iterator pos) {
+    return tree.erase(pos);
+  }
+  iterator erase(const_iterator first, const_iterator last) {
+    return tree.erase(first, last);
+  }
+  template <class Pred>
+  friend size_type erase_if(IntervalMap& map, Pred pred) {
+    return map.tree.erase_if([&](const iterator i) { return pred(*i); });
+  }
+  overlap_range overlapping(const Key& lo, const Key& hi) const {
+    return query(lo, hi, false);
+  }
+  overlap_range overlapping(const interval_type& interval) const {
+    return query(interval.start, interval.end, false);
+  }
+  overlap_range stabbing(const Key& point) const {
+    return query(point, point, true);
+  }
+  bool overlaps(const Key& lo, const Key& hi) const {
+    return !overlapping(lo, hi).empty();
+  }
+  key_compare key_comp() const {
+    return tree.key_comp();
+  }
+};
+
+#endif
@@ -3,7 +3,9 @@
 
 #include "Tree.hpp"
 
-template <class Key, class T, class Compare, bool UniqueKeys>
+template <class Key, class T, class Compare, bool UniqueKeys,
+          class Augment = NoAugment, class Balance = RedBlack,
+          std::size_t InlineCapacity = 0, class Index = NoIndex>
 class BasicMap {
 public:
   using key_type = Key;
@@ -25,15 +27,49 @@ private:
     }
   };
 
-  using Tree = RbTree<Key, value_type, SelectFirst, Compare, UniqueKeys>;
+  using Tree = RbTree<Key, value_type, SelectFirst, Compare, UniqueKeys,
+                      Augment, Balance, InlineCapacity>;
   Tree tree;
+  [[no_unique_address]] NodeIndex<Key, typename Tree::const_iterator,
+                                  SelectFirst, Index> index;
+
+  static constexpr bool augmented = !std::is_same_v<Augment, NoAugment>;
+  static constexpr bool hashed = decltype(index)::enabled;
+  static_assert(!hashed || (UniqueKeys && InlineCapacity == 0));
+  // The index hashes with std::hash and probes with ==, which only agree
+  // with the tree's order for the standard less-than.
+  static_assert(!hashed || std::is_same_v<Compare, std::less<Key>> ||
+                std::is_same_v<Compare, std::less<>>);
+
+  void reindex() {
+    if constexpr (hashed)
+      index.assign(tree.begin(), tree.end(), tree.size());
+  }
+
+  template <class Result>
+  Result indexed(Result result) {
+    if constexpr (hashed) {
+      if constexpr (requires { result.second; }) {
+        if (result.second)
+          index.insert(result.first);
+      } else
+        index.insert(result);
+    }
+    return result;
+  }
 
 public:
   BasicMap() = default;
   ~BasicMap() = default;
-  BasicMap(const BasicMap&) = default;
+  BasicMap(const BasicMap& other) : tree(other.tree) {
+    reindex();
+  }
   BasicMap(BasicMap&&) = default;
-  BasicMap& operator=(const BasicMap&) = default;
+  BasicMap& operator=(const BasicMap& other) {
+    tree = other.tree;
+    reindex();
+    return *this;
+  }
   BasicMap& operator=(BasicMap&&) = default;
 
   BasicMap(const Compare& comp) : tree(comp) {}
@@ -42,22 +78,36 @@ public:
       tree(comp) {
     while (first != last)
       tree.insert(*first++);
+    reindex();
+  }
+  template <std::random_access_iterator RandomIt>
+  BasicMap(Parallel policy, RandomIt first, RandomIt last,
+           Compare comp = Compare()) :
+      tree(comp) {
+    tree.build(policy, first, last);
+    reindex();
   }
   BasicMap(std::initializer_list<value_type> init, Compare comp = Compare()) :
       tree(comp) {
     for (auto&& e : init)
       tree.insert(e);
+    reindex();
   }
   BasicMap& operator=(std::initializer_list<value_type> init) {
-    tree.clear();
-    for (auto&& e : init)
-      tree.insert(e);
+    tree.assign(init.begin(), init.end());
+    reindex();
+    return *this;
+  }
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    tree.assign(first, last);
+    reindex();
   }
   allocator_type get_allocator() const {
     return allocator_type();
   }
   mapped_type& at(const key_type& key)
-  requires UniqueKeys
+  requires(UniqueKeys && !augmented)
   {
     iterator i = tree.lower_bound(key);
     return i->second;
@@ -69,31 +119,52 @@ public:
     return i->second;
   }
   mapped_type& operator[](const key_type& key)
-  requires UniqueKeys
+  requires(UniqueKeys && !augmented)
   {
+    if constexpr (hashed)
+      if (NodeBase* x = index.find(key))
+        return iterator(x)->second;
     iterator i = tree.lower_bound(key);
     if (i == tree.end() || key_comp()(key, i->first))
-      i = tree.insert_hint(i, value_type(std::piecewise_construct,
-                                         std::tuple<const key_type&>(key),
-                                         std::tuple<>()));
+      i = indexed(tree.insert_hint(
+          i, value_type(std::piecewise_construct,
+                        std::tuple<const key_type&>(key), std::tuple<>())));
     return i->second;
   }
   mapped_type& operator[](key_type&& key)
-  requires UniqueKeys
+  requires(UniqueKeys && !augmented)
   {
+    if constexpr (hashed)
+      if (NodeBase* x = index.find(key))
+        return iterator(x)->second;
     iterator i = tree.lower_bound(key);
     if (i == tree.end() || key_comp()(key, i->first))
-      i = tree.insert_hint(i, value_type(std::piecewise_construct,
-                                         std::forward_as_tuple(std::move(key)),
-                                         std::tuple<>()));
+      i = indexed(tree.insert_hint(
+          i, value_type(std::piecewise_construct,
+                        std::forward_as_tuple(std::move(key)),
+                        std::tuple<>())));
     return i->second;
   }
 
-  using iterator = Tree::iterator;
+  using iterator = std::conditional_t<augmented, typename Tree::const_iterator,
+                                      typename Tree::iterator>;
   using const_iterator = Tree::const_iterator;
   using reverse_iterator = std::reverse_iterator<iterator>;
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj)
+  requires UniqueKeys
+  {
+    typename Tree::iterator i = tree.lower_bound(key);
+    if (i == tree.end() || key_comp()(key, i->first))
+      return indexed(std::pair<iterator, bool>(
+          tree.insert_hint(i, value_type(key, std::forward<M>(obj))), true));
+    i->second = std::forward<M>(obj);
+    tree.update(i);
+    return {i, false};
+  }
+
   iterator begin() {
     return tree.begin();
   }
@@ -139,77 +210,145 @@ public:
   size_type max_size() const {
     return std::allocator_traits<std::allocator<key_type>>::max_size();
   }
+  bool verify() const {
+    if (!tree.verify())
+      return false;
+    if constexpr (hashed) {
+      if (index.size() != tree.size())
+        return false;
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+        if (index.find(it->first) != it.node)
+          return false;
+    }
+    return true;
+  }
   void clear() {
     tree.clear();
+    if constexpr (hashed)
+      index.clear();
+  }
+  void compact() {
+    tree.compact();
+    reindex();
   }
   auto insert(const value_type& value) {
-    return tree.insert(value);
+    return indexed(tree.insert(value));
   }
   auto insert(value_type&& value) {
-    return tree.insert(std::move(value));
+    return indexed(tree.insert(std::move(value)));
   }
   template <class Pair>
   requires std::is_constructible_v<value_type, Pair>
   auto insert(Pair&& pair) {
-    return tree.insert(value_type(std::forward<Pair>(pair)));
+    return indexed(tree.insert(value_type(std::forward<Pair>(pair))));
   }
   iterator insert(const_iterator pos, const value_type& value) {
-    return tree.insert_hint(pos, value);
+    return indexed(tree.insert_hint(pos, value));
   }
   iterator insert(const_iterator pos, value_type&& value) {
-    return tree.insert_hint(pos, std::move(value));
+    return indexed(tree.insert_hint(pos, std::move(value)));
   }
   template <class Pair>
   requires std::is_constructible_v<value_type, Pair>
   iterator insert(const_iterator pos, Pair&& pair) {
-    return tree.insert_hint(pos, value_type(std::forward<Pair>(pair)));
+    return indexed(tree.insert_hint(pos, value_type(std::forward<Pair>(pair))));
+  }
+  auto push_back(const value_type& value) {
+    return indexed(tree.push_back(value));
+  }
+  auto push_back(value_type&& value) {
+    return indexed(tree.push_back(std::move(value)));
+  }
+  template <class InputIterator>
+  void append(InputIterator first, InputIterator last) {
+    while (first != last)
+      push_back(*first++);
   }
   template <class InputIterator>
   void insert(InputIterator first, InputIterator last) {
     while (first != last)
-      tree.insert(first++);
+      insert(*first++);
   }
   void insert(std::initializer_list<value_type> init) {
     for (auto&& e : init)
-      tree.insert(e);
+      insert(e);
   }
   template <class... Args>
   auto emplace(Args... args) {
-    return tree.insert(value_type(std::forward<Args>(args)...));
+    return insert(value_type(std::forward<Args>(args)...));
   }
   template <class... Args>
   iterator emplace_hint(const_iterator hint, Args&&... args) {
-    return tree.insert(hint, value_type(std::forward<Args>(args)...));
+    return insert(hint, value_type(std::forward<Args>(args)...));
   }
-  iterator erase(iterator pos) {
-    return tree.erase(pos);
+  iterator erase(iterator pos)
+  requires(!augmented)
+  {
+    return erase(const_iterator(pos));
   }
   iterator erase(const_iterator pos) {
+    if constexpr (hashed)
+      index.erase(pos);
     return tree.erase(pos);
   }
   iterator erase(const_iterator first, const_iterator last) {
-    while (first != last)
-      tree.erase(first++);
-    return iterator(last.node);
+    if constexpr (hashed)
+      for (const_iterator i = first; i != last; ++i)
+        index.erase(i);
+    return tree.erase(first, last);
   }
   size_type erase(const Key& key) {
-    auto p = tree.equal_range(key);
-    const size_type old_size = tree.size();
-    while (p.first != p.second)
-      tree.erase(p.first++);
-    return old_size - tree.size();
+    if constexpr (hashed) {
+      NodeBase* const x = index.find(key);
+      if (x)
+        erase(const_iterator(x));
+      return x != nullptr;
+    } else
+      return tree.erase(key);
+  }
+  size_type pop_front(size_type n = 1) {
+    n = std::min(n, size());
+    erase(cbegin(), std::next(cbegin(), n));
+    return n;
+  }
+  template <class Pred>
+  friend size_type erase_if(BasicMap& map, Pred pred) {
+    return map.tree.erase_if([&](const iterator i) { return pred(*i); },
+                             [&](const iterator i) {
+                               if constexpr (hashed)
+                                 map.index.erase(i);
+                             });
   }
   void swap(BasicMap& other) {
     std::swap(*this, other);
   }
   iterator find(const Key& key) {
-    return tree.find(key);
+    if constexpr (hashed) {
+      NodeBase* const x = index.find(key);
+      return x ? iterator(x) : end();
+    } else
+      return tree.find(key);
   }
   const_iterator find(const Key& key) const {
-    return tree.find(key);
+    if constexpr (hashed) {
+      NodeBase* const x = index.find(key);
+      return x ? const_iterator(x) : end();
+    } else
+      return tree.find(key);
   }
   size_type count(const Key& key) const {
-    return tree.count(key);
+    if constexpr (hashed)
+      return index.find(key) != nullptr;
+    else
+      return tree.count(key);
+  }
+  bool contains(const Key& key) const {
+    return find(key) != end();
+  }
+  std::size_t index_memory() const
+  requires hashed
+  {
+    return index.memory();
   }
   std::pair<iterator, iterator> equal_range(const Key& key) {
     return tree.equal_range(key);
@@ -229,6 +368,69 @@ public:
   const_iterator lower_bound(const Key& key) const {
     return tree.lower_bound(key);
   }
+  iterator lower_bound_from(const_iterator pos, const Key& key) {
+    return tree.lower_bound_from(pos, key);
+  }
+  const_iterator lower_bound_from(const_iterator pos, const Key& key) const {
+    return tree.lower_bound_from(pos, key);
+  }
+  iterator upper_bound_from(const_iterator pos, const Key& key) {
+    return tree.upper_bound_from(pos, key);
+  }
+  const_iterator upper_bound_from(const_iterator pos, const Key& key) const {
+    return tree.upper_bound_from(pos, key);
+  }
+  iterator find_from(const_iterator pos, const Key& key) {
+    return tree.find_from(pos, key);
+  }
+  const_iterator find_from(const_iterator pos, const Key& key) const {
+    return tree.find_from(pos, key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  iterator find(const K& key) {
+    return tree.find(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  const_iterator find(const K& key) const {
+    return tree.find(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  size_type count(const K& key) const {
+    return tree.count(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  std::pair<iterator, iterator> equal_range(const K& key) {
+    return tree.equal_range(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+    return tree.equal_range(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  iterator upper_bound(const K& key) {
+    return tree.upper_bound(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  const_iterator upper_bound(const K& key) const {
+    return tree.upper_bound(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  iterator lower_bound(const K& key) {
+    return tree.lower_bound(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  const_iterator lower_bound(const K& key) const {
+    return tree.lower_bound(key);
+  }
 
   class value_compare {
   protected:
@@ -246,6 +448,51 @@ public:
   value_compare value_comp() const {
     return value_compare(tree.key_comp());
   }
+  using summary_type = Augment::value_type;
+  summary_type aggregate() const {
+    return tree.aggregate();
+  }
+  summary_type aggregate(const_iterator first, const_iterator last) const {
+    return tree.aggregate(first, last);
+  }
+  summary_type aggregate(const Key& lo, const Key& hi) const {
+    return tree.aggregate(tree.lower_bound(lo), tree.lower_bound(hi));
+  }
+  template <class Pred>
+  const_iterator prefix_search(Pred pred) const {
+    return tree.prefix_search(pred);
+  }
+  template <class F>
+  void diff(const BasicMap& other, F f) const
+  requires UniqueKeys
+  {
+    tree.diff(other.tree, f);
+  }
+  std::vector<std::pair<const_iterator, const_iterator>>
+  split_ranges(std::size_t n) const {
+    return tree.split_ranges(tree.begin(), tree.end(), n);
+  }
+  std::vector<std::pair<const_iterator, const_iterator>>
+  split_ranges(const_iterator first, const_iterator last, std::size_t n) const {
+    return tree.split_ranges(first, last, n);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, F f) {
+    tree.parallel_for_each(policy, begin(), end(), f);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, F f) const {
+    tree.parallel_for_each(policy, begin(), end(), f);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, iterator first, iterator last, F f) {
+    tree.parallel_for_each(policy, first, last, f);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, const_iterator first,
+                         const_iterator last, F f) const {
+    tree.parallel_for_each(policy, first, last, f);
+  }
   bool operator==(const BasicMap& other) {
     return tree == other.tree;
   }
@@ -258,5 +505,23 @@ template <class Key, class T, class Compare = std::less<Key>>
 using Map = BasicMap<Key, T, Compare, true>;
 template <class Key, class T, class Compare = std::less<Key>>
 using MultiMap = BasicMap<Key, T, Compare, false>;
+template <class Key, class T, class Compare = std::less<Key>>
+using MerkleMap = BasicMap<Key, T, Compare, true, MerkleHash>;
+template <class Key, class T, class Monoid, class Compare = std::less<Key>>
+using AugmentedMap = BasicMap<Key, T, Compare, true, Monoid>;
+template <class Key, class T, class Monoid, class Compare = std::less<Key>>
+using AugmentedMultiMap = BasicMap<Key, T, Compare, false, Monoid>;
+template <class Key, class T, class Compare = std::less<Key>>
+using AvlMap = BasicMap<Key, T, Compare, true, NoAugment, Avl>;
+template <class Key, class T, class Compare = std::less<Key>>
+using TreapMap = BasicMap<Key, T, Compare, true, NoAugment, Treap>;
+template <class Key, class T, class Compare = std::less<Key>>
+using SplayMap = BasicMap<Key, T, Compare, true, NoAugment, Splay>;
+template <class Key, class T, std::size_t N = 16,
+          class Compare = std::less<Key>>
+using SmallMap = BasicMap<Key, T, Compare, true, NoAugment, RedBlack, N>;
+template <class Key, class T, class Compare = std::less<Key>>
+using HashedMap =
+    BasicMap<Key, T, Compare, true, NoAugment, RedBlack, 0, HashIndex>;
 
 #endif
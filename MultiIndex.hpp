@@ -0,0 +1,366 @@
+#ifndef MULTI_INDEX_HPP
+#define MULTI_INDEX_HPP
+
+#include "Tree.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template <class KeyOf, class Compare = std::less<>>
+struct UniqueIndex {
+  using key_of = KeyOf;
+  using compare = Compare;
+  static constexpr bool unique = true;
+};
+
+template <class KeyOf, class Compare = std::less<>>
+struct OrderedIndex {
+  using key_of = KeyOf;
+  using compare = Compare;
+  static constexpr bool unique = false;
+};
+
+template <class Value, class... Indices>
+class MultiIndex {
+  static constexpr std::size_t count = sizeof...(Indices);
+  static_assert(count > 0);
+  static_assert((std::is_empty_v<typename Indices::compare> && ...),
+                "MultiIndex comparators must be stateless");
+
+  struct Node {
+    NodeBase hooks[count];
+    Value val;
+
+    template <class... Args>
+    Node(Args&&... args) : hooks{}, val(std::forward<Args>(args)...) {}
+  };
+
+  template <std::size_t I>
+  struct Hook {
+    using value_type = Value;
+    static constexpr bool augmented = false;
+
+    static Node* up_cast(const NodeBase* x) {
+      return reinterpret_cast<Node*>(reinterpret_cast<std::uintptr_t>(x) -
+                                     I * sizeof(NodeBase));
+    }
+
+    static void update(NodeBase*) {}
+    static std::size_t deep_erase(Node*) {
+      return 0;
+    }
+  };
+
+  template <std::size_t I>
+  using Index = std::tuple_element_t<I, std::tuple<Indices...>>;
+
+  template <std::size_t... Is>
+  static auto headers_for(std::index_sequence<Is...>)
+      -> std::tuple<Header<Hook<Is>, RedBlack>...>;
+
+  decltype(headers_for(std::make_index_sequence<count>())) headers;
+
+  template <std::size_t I>
+  static decltype(auto) key(const NodeBase* x) {
+    return typename Index<I>::key_of()(Hook<I>::up_cast(x)->val);
+  }
+
+  struct Slot {
+    NodeBase* parent;
+    bool left;
+  };
+
+  template <std::size_t I>
+  Node* place(const Value& v, Slot& slot) const {
+    auto& header = std::get<I>(headers);
+    const typename Index<I>::compare comp;
+    const auto& k = typename Index<I>::key_of()(v);
+    NodeBase* x = header.root();
+    NodeBase* y = const_cast<NodeBase*>(&header.super_root);
+    bool left = true;
+    while (x) {
+      y = x;
+      left = comp(k, key<I>(x));
+      x = left ? x->left : x->right;
+    }
+    slot = {y, left};
+    if constexpr (Index<I>::unique) {
+      NodeBase* j = y;
+      if (left) {
+        if (j == header.leftmost())
+          return nullptr;
+        j = (--::iterator<true, Hook<I>>(j)).node;
+      }
+      if (!comp(key<I>(j), k))
+        return Hook<I>::up_cast(j);
+    }
+    return nullptr;
+  }
+
+  template <class Make, std::size_t... Is>
+  std::pair<Node*, bool> link(const Value& v, Make make,
+                              std::index_sequence<Is...>) {
+    Slot slots[count];
+    Node* clash = nullptr;
+    ((clash = clash ? clash : place<Is>(v, slots[Is])), ...);
+    if (clash)
+      return {clash, false};
+    Node* const z = make();
+    (std::get<Is>(headers).insert(slots[Is].left, &z->hooks[Is],
+                                  slots[Is].parent),
+     ...);
+    return {z, true};
+  }
+
+  template <class Make>
+  auto link(const Value& v, Make make) {
+    const auto [z, inserted] =
+        link(v, make, std::make_index_sequence<count>());
+    return std::pair(iterator<0>(&z->hooks[0]), inserted);
+  }
+
+  template <std::size_t... Is>
+  void unlink(Node* z, std::index_sequence<Is...>) {
+    (std::get<Is>(headers).extract(&z->hooks[Is]), ...);
+  }
+
+  template <std::size_t I>
+  bool ordered() const {
+    const typename Index<I>::compare comp;
+    const auto before = [&](const Value& a, const Value& b) {
+      return comp(typename Index<I>::key_of()(a),
+                  typename Index<I>::key_of()(b));
+    };
+    const auto view = get<I>();
+    if constexpr (Index<I>::unique)
+      return std::adjacent_find(view.begin(), view.end(),
+                                [&](const Value& a, const Value& b) {
+                                  return !before(a, b);
+                                }) == view.end();
+    else
+      return std::is_sorted(view.begin(), view.end(), before);
+  }
+
+  template <std::size_t... Is>
+  bool verify(std::index_sequence<Is...>) const {
+    return ((std::get<Is>(headers).verify() &&
+             std::get<Is>(headers).node_count == size() && ordered<Is>()) &&
+            ...);
+  }
+
+public:
+  using value_type = Value;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_reference = const Value&;
+
+  template <std::size_t I>
+  using iterator = ::iterator<true, Hook<I>>;
+
+  template <std::size_t I, bool Const>
+  class View {
+    friend class MultiIndex;
+
+    std::conditional_t<Const, const MultiIndex, MultiIndex>* owner;
+
+    explicit View(decltype(owner) m) : owner(m) {}
+
+    auto& header() const {
+      return std::get<I>(owner->headers);
+    }
+
+    template <class Before>
+    NodeBase* bound(Before before) const {
+      NodeBase* x = header().root();
+      NodeBase* y = const_cast<NodeBase*>(&header().super_root);
+      while (x)
+        if (!before(x))
+          y = x, x = x->left;
+        else
+          x = x->right;
+      return y;
+    }
+
+  public:
+    using key_compare = Index<I>::compare;
+    using iterator = MultiIndex::iterator<I>;
+    using const_iterator = iterator;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+
+    iterator begin() const {
+      return iterator(header().leftmost());
+    }
+    iterator end() const {
+      return iterator(const_cast<NodeBase*>(&header().super_root));
+    }
+    reverse_iterator rbegin() const {
+      return reverse_iterator(end());
+    }
+    reverse_iterator rend() const {
+      return reverse_iterator(begin());
+    }
+    size_type size() const {
+      return header().node_count;
+    }
+    bool empty() const {
+      return size() == 0;
+    }
+    template <class K>
+    iterator lower_bound(const K& k) const {
+      const key_compare comp;
+      return iterator(
+          bound([&](const NodeBase* x) { return comp(key<I>(x), k); }));
+    }
+    template <class K>
+    iterator upper_bound(const K& k) const {
+      const key_compare comp;
+      return iterator(
+          bound([&](const NodeBase* x) { return !comp(k, key<I>(x)); }));
+    }
+    template <class K>
+    std::pair<iterator, iterator> equal_range(const K& k) const {
+      return {lower_bound(k), upper_bound(k)};
+    }
+    template <class K>
+    iterator find(const K& k) const {
+      const iterator i = lower_bound(k);
+      return i == end() || key_compare()(k, key<I>(i.node)) ? end() : i;
+    }
+    template <class K>
+    size_type count(const K& k) const {
+      const auto [first, last] = equal_range(k);
+      return std::distance(first, last);
+    }
+    template <class K>
+    bool contains(const K& k) const {
+      return find(k) != end();
+    }
+    iterator erase(iterator pos) const
+    requires(!Const)
+    {
+      const iterator next = std::next(pos);
+      owner->template erase<I>(pos);
+      return next;
+    }
+    template <class K>
+    size_type erase(const K& k) const
+    requires(!Const)
+    {
+      auto [first, last] = equal_range(k);
+      size_type n = 0;
+      while (first != last)
+        first = erase(first), ++n;
+      return n;
+    }
+  };
+
+  MultiIndex() = default;
+  MultiIndex(std::initializer_list<Value> init) {
+    for (const Value& v : init)
+      insert(v);
+  }
+  MultiIndex(const MultiIndex& other) {
+    for (const Value& v : other.template get<0>())
+      insert(v);
+  }
+  MultiIndex(MultiIndex&&) = default;
+  MultiIndex& operator=(const MultiIndex& other) {
+    if (this != &other)
+      *this = MultiIndex(other);
+    return *this;
+  }
+  MultiIndex& operator=(MultiIndex&& other) {
+    if (this != &other) {
+      clear();
+      headers = std::move(other.headers);
+    }
+    return *this;
+  }
+  ~MultiIndex() {
+    clear();
+  }
+
+  template <std::size_t I>
+  View<I, false> get() {
+    return View<I, false>(this);
+  }
+  template <std::size_t I>
+  View<I, true> get() const {
+    return View<I, true>(this);
+  }
+
+  size_type size() const {
+    return std::get<0>(headers).node_count;
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+  bool verify() const {
+    return verify(std::make_index_sequence<count>());
+  }
+
+  std::pair<iterator<0>, bool> insert(const Value& v) {
+    return link(v, [&] { return new Node(v); });
+  }
+  std::pair<iterator<0>, bool> insert(Value&& v) {
+    return link(v, [&] { return new Node(std::move(v)); });
+  }
+  template <class... Args>
+  std::pair<iterator<0>, bool> emplace(Args&&... args) {
+    Node* const z = new Node(std::forward<Args>(args)...);
+    const auto result = link(z->val, [=] { return z; });
+    if (!result.second)
+      delete z;
+    return result;
+  }
+
+  template <std::size_t To, std::size_t From>
+  iterator<To> project(iterator<From> it) const {
+    if (it.node == &std::get<From>(headers).super_root)
+      return get<To>().end();
+    return iterator<To>(&Hook<From>::up_cast(it.node)->hooks[To]);
+  }
+
+  template <std::size_t I>
+  void erase(iterator<I> pos) {
+    Node* const z = Hook<I>::up_cast(pos.node);
+    unlink(z, std::make_index_sequence<count>());
+    delete z;
+  }
+
+  template <std::size_t I, class F>
+  bool modify(iterator<I> pos, F&& f) {
+    Node* const z = Hook<I>::up_cast(pos.node);
+    unlink(z, std::make_index_sequence<count>());
+    try {
+      std::forward<F>(f)(z->val);
+    } catch (...) {
+      delete z;
+      throw;
+    }
+    if (link(z->val, [=] { return z; }).second)
+      return true;
+    delete z;
+    return false;
+  }
+
+  void clear() {
+    NodeBase* x = std::get<0>(headers).root();
+    while (x)
+      if (NodeBase* y = x->left) {
+        x->left = y->right;
+        y->right = x;
+        x = y;
+      } else {
+        NodeBase* const next = x->right;
+        delete Hook<0>::up_cast(x);
+        x = next;
+      }
+    std::apply([](auto&... h) { (h.clear(), ...); }, headers);
+  }
+};
+
+#endif
@@ -0,0 +1,337 @@
+#ifndef SEPARATED_MAP_HPP
+#define SEPARATED_MAP_HPP
+
+#include "Tree.hpp"
+#include <memory>
+#include <utility>
+
+template <class T>
+class Slab {
+  union Slot {
+    Slot* next;
+    T value;
+
+    Slot() {}
+    ~Slot() {}
+  };
+
+  static constexpr std::size_t per_block =
+      std::max<std::size_t>(NodeChunk::bytes / sizeof(Slot), 16);
+
+  std::vector<std::unique_ptr<Slot[]>> blocks;
+  std::size_t used = per_block;
+  Slot* free = nullptr;
+
+  Slot* acquire() {
+    if (free)
+      return std::exchange(free, free->next);
+    if (used == per_block) {
+      blocks.emplace_back(new Slot[per_block]);
+      used = 0;
+    }
+    return &blocks.back()[used++];
+  }
+
+public:
+  Slab() = default;
+  Slab(Slab&& other) :
+      blocks(std::move(other.blocks)),
+      used(std::exchange(other.used, per_block)),
+      free(std::exchange(other.free, nullptr)) {}
+  Slab& operator=(Slab&& other) {
+    blocks = std::move(other.blocks);
+    used = std::exchange(other.used, per_block);
+    free = std::exchange(other.free, nullptr);
+    return *this;
+  }
+
+  template <class... Args>
+  T* make(Args&&... args) {
+    Slot* s = acquire();
+    std::construct_at(&s->value, std::forward<Args>(args)...);
+    return &s->value;
+  }
+
+  void drop(T* p) {
+    Slot* s = reinterpret_cast<Slot*>(p);
+    std::destroy_at(p);
+    s->next = free;
+    free = s;
+  }
+
+  void reset() {
+    blocks.clear();
+    used = per_block;
+    free = nullptr;
+  }
+};
+
+template <class Key, class T, class Compare = std::less<Key>>
+class SeparatedMap {
+  struct Entry {
+    Key key;
+    T* value;
+  };
+
+  struct SelectKey {
+    const Key& operator()(const Entry& e) const {
+      return e.key;
+    }
+  };
+
+  using Tree = RbTree<Key, Entry, SelectKey, Compare, true>;
+  Tree tree;
+  Slab<T> slab;
+
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<const Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare = Compare;
+
+  template <bool Const>
+  class Iterator {
+    friend class SeparatedMap;
+
+    Tree::const_iterator it;
+
+    explicit Iterator(Tree::const_iterator i) : it(i) {}
+
+  public:
+    using value_type = SeparatedMap::value_type;
+    using reference =
+        std::pair<const Key&, std::conditional_t<Const, const T&, T&>>;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+
+    struct pointer {
+      reference ref;
+
+      const reference* operator->() const {
+        return &ref;
+      }
+    };
+
+    Iterator() = default;
+    Iterator(const Iterator&) = default;
+    Iterator& operator=(const Iterator&) = default;
+    Iterator(const Iterator<false>& other)
+    requires Const
+        : it(other.it) {}
+
+    reference operator*() const {
+      return {it->key, *it->value};
+    }
+
+    pointer operator->() const {
+      return {**this};
+    }
+
+    Iterator& operator++() {
+      ++it;
+      return *this;
+    }
+
+    Iterator operator++(int) {
+      return Iterator(it++);
+    }
+
+    Iterator& operator--() {
+      --it;
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      return Iterator(it--);
+    }
+
+    bool operator==(const Iterator&) const = default;
+  };
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reference = iterator::reference;
+  using const_reference = const_iterator::reference;
+
+private:
+  template <class K, class... Args>
+  iterator emplace_at(Tree::const_iterator hint, K&& key, Args&&... args) {
+    T* value = slab.make(std::forward<Args>(args)...);
+    try {
+      return iterator(
+          tree.insert_hint(hint, Entry{std::forward<K>(key), value}));
+    } catch (...) {
+      slab.drop(value);
+      throw;
+    }
+  }
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_key(K&& key, Args&&... args) {
+    auto i = tree.lower_bound(key);
+    if (i != tree.end() && !key_comp()(key, i->key))
+      return {iterator(i), false};
+    return {emplace_at(i, std::forward<K>(key), std::forward<Args>(args)...),
+            true};
+  }
+
+  void drop_values() {
+    for (const Entry& e : tree)
+      slab.drop(e.value);
+  }
+
+public:
+  SeparatedMap() = default;
+  explicit SeparatedMap(const Compare& comp) : tree(comp) {}
+  SeparatedMap(std::initializer_list<value_type> init,
+               const Compare& comp = Compare()) :
+      tree(comp) {
+    for (auto&& e : init)
+      insert(e);
+  }
+  SeparatedMap(const SeparatedMap& other) : tree(other.key_comp()) {
+    for (auto&& [k, v] : other)
+      emplace_at(tree.end(), k, v);
+  }
+  SeparatedMap(SeparatedMap&&) = default;
+  SeparatedMap& operator=(const SeparatedMap& other) {
+    if (this != &other)
+      *this = SeparatedMap(other);
+    return *this;
+  }
+  SeparatedMap& operator=(SeparatedMap&& other) {
+    if (this != &other) {
+      drop_values();
+      tree = std::move(other.tree);
+      slab = std::move(other.slab);
+    }
+    return *this;
+  }
+  ~SeparatedMap() {
+    drop_values();
+  }
+
+  iterator begin() {
+    return iterator(tree.begin());
+  }
+  const_iterator begin() const {
+    return const_iterator(tree.begin());
+  }
+  iterator end() {
+    return iterator(tree.end());
+  }
+  const_iterator end() const {
+    return const_iterator(tree.end());
+  }
+  reverse_iterator rbegin() {
+    return reverse_iterator(end());
+  }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() {
+    return reverse_iterator(begin());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  bool empty() const {
+    return tree.size() == 0;
+  }
+  size_type size() const {
+    return tree.size();
+  }
+  bool verify() const {
+    return tree.verify();
+  }
+  void clear() {
+    drop_values();
+    tree.clear();
+    slab.reset();
+  }
+  mapped_type& at(const key_type& key) {
+    return *tree.find(key)->value;
+  }
+  const mapped_type& at(const key_type& key) const {
+    return *tree.find(key)->value;
+  }
+  mapped_type& operator[](const key_type& key) {
+    return try_emplace_key(key).first->second;
+  }
+  mapped_type& operator[](key_type&& key) {
+    return try_emplace_key(std::move(key)).first->second;
+  }
+  std::pair<iterator, bool> insert(const value_type& value) {
+    return try_emplace_key(value.first, value.second);
+  }
+  std::pair<iterator, bool> insert(value_type&& value) {
+    return try_emplace_key(value.first, std::move(value.second));
+  }
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const key_type& key, Args&&... args) {
+    return try_emplace_key(key, std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args) {
+    return try_emplace_key(std::move(key), std::forward<Args>(args)...);
+  }
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const key_type& key, M&& obj) {
+    auto [i, inserted] = try_emplace_key(key, std::forward<M>(obj));
+    if (!inserted)
+      i->second = std::forward<M>(obj);
+    return {i, inserted};
+  }
+  iterator erase(const_iterator pos) {
+    T* value = pos.it->value;
+    auto next = tree.erase(pos.it);
+    slab.drop(value);
+    return iterator(next);
+  }
+  size_type erase(const Key& key) {
+    auto i = tree.find(key);
+    if (i == tree.end())
+      return 0;
+    erase(const_iterator(i));
+    return 1;
+  }
+  iterator find(const Key& key) {
+    return iterator(tree.find(key));
+  }
+  const_iterator find(const Key& key) const {
+    return const_iterator(tree.find(key));
+  }
+  size_type count(const Key& key) const {
+    return tree.count(key);
+  }
+  bool contains(const Key& key) const {
+    return tree.find(key) != tree.end();
+  }
+  iterator lower_bound(const Key& key) {
+    return iterator(tree.lower_bound(key));
+  }
+  const_iterator lower_bound(const Key& key) const {
+    return const_iterator(tree.lower_bound(key));
+  }
+  iterator upper_bound(const Key& key) {
+    return iterator(tree.upper_bound(key));
+  }
+  const_iterator upper_bound(const Key& key) const {
+    return const_iterator(tree.upper_bound(key));
+  }
+  key_compare key_comp() const {
+    return tree.key_comp();
+  }
+  void compact() {
+    tree.compact();
+  }
+  friend bool operator==(const SeparatedMap& x, const SeparatedMap& y) {
+    return std::equal(x.begin(), x.end(), y.begin(), y.end());
+  }
+};
+
+#endif
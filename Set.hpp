@@ -3,10 +3,39 @@
 
 #include "Tree.hpp"
 
-template <class Key, class Compare, bool AreKeysUnique>
+template <class Key, class Compare, bool AreKeysUnique,
+          class Augment = NoAugment, class Balance = RedBlack,
+          std::size_t InlineCapacity = 0, class Index = NoIndex>
 class BasicSet {
-  using Tree = RbTree<Key, Key, std::identity, Compare, AreKeysUnique>;
+  using Tree = RbTree<Key, Key, std::identity, Compare, AreKeysUnique, Augment,
+                      Balance, InlineCapacity>;
   Tree tree;
+  [[no_unique_address]] NodeIndex<Key, typename Tree::const_iterator,
+                                  std::identity, Index> index;
+
+  static constexpr bool hashed = decltype(index)::enabled;
+  static_assert(!hashed || (AreKeysUnique && InlineCapacity == 0));
+  // The index hashes with std::hash and probes with ==, which only agree
+  // with the tree's order for the standard less-than.
+  static_assert(!hashed || std::is_same_v<Compare, std::less<Key>> ||
+                std::is_same_v<Compare, std::less<>>);
+
+  void reindex() {
+    if constexpr (hashed)
+      index.assign(tree.begin(), tree.end(), tree.size());
+  }
+
+  template <class Result>
+  Result indexed(Result result) {
+    if constexpr (hashed) {
+      if constexpr (requires { result.second; }) {
+        if (result.second)
+          index.insert(result.first);
+      } else
+        index.insert(result);
+    }
+    return result;
+  }
 
 public:
   using key_type = Key;
@@ -27,9 +56,15 @@ public:
 
   BasicSet() = default;
   ~BasicSet() = default;
-  BasicSet(const BasicSet& other) = default;
+  BasicSet(const BasicSet& other) : tree(other.tree) {
+    reindex();
+  }
   BasicSet(BasicSet&& other) = default;
-  BasicSet& operator=(const BasicSet&) = default;
+  BasicSet& operator=(const BasicSet& other) {
+    tree = other.tree;
+    reindex();
+    return *this;
+  }
   BasicSet& operator=(BasicSet&&) = default;
 
   explicit BasicSet(const Compare& compare) : tree(compare) {};
@@ -39,17 +74,31 @@ public:
       tree(compare) {
     while (first != last)
       tree.insert(*first++);
+    reindex();
+  }
+  template <std::random_access_iterator RandomIt>
+  BasicSet(Parallel policy, RandomIt first, RandomIt last,
+           const Compare& compare = Compare()) :
+      tree(compare) {
+    tree.build(policy, first, last);
+    reindex();
   }
   BasicSet(std::initializer_list<value_type> init,
            const Compare& compare = Compare()) :
       tree(compare) {
     for (auto&& e : init)
       tree.insert(e);
+    reindex();
   }
   BasicSet& operator=(std::initializer_list<value_type> init) {
-    tree.clear();
-    for (auto&& e : init)
-      tree.insert(e);
+    tree.assign(init.begin(), init.end());
+    reindex();
+    return *this;
+  }
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    tree.assign(first, last);
+    reindex();
   }
   allocator_type get_allocator() const {
     return allocator_type();
@@ -100,29 +149,58 @@ public:
   size_type max_size() const {
     return std::allocator_traits<std::allocator<key_type>>::max_size();
   }
+  bool verify() const {
+    if (!tree.verify())
+      return false;
+    if constexpr (hashed) {
+      if (index.size() != tree.size())
+        return false;
+      for (auto it = tree.begin(); it != tree.end(); ++it)
+        if (index.find(*it) != it.node)
+          return false;
+    }
+    return true;
+  }
   void clear() {
     tree.clear();
+    if constexpr (hashed)
+      index.clear();
+  }
+  void compact() {
+    tree.compact();
+    reindex();
   }
   auto insert(const value_type& value) {
-    return tree.insert(value);
+    return indexed(tree.insert(value));
   }
   auto insert(value_type&& value) {
-    return tree.insert(std::move(value));
+    return indexed(tree.insert(std::move(value)));
   }
   iterator insert(const_iterator pos, const value_type& value) {
-    return tree.insert_hint(pos, value);
+    return indexed(tree.insert_hint(pos, value));
   }
   iterator insert(const_iterator pos, value_type&& value) {
-    return tree.insert_hint(pos, std::move(value));
+    return indexed(tree.insert_hint(pos, std::move(value)));
+  }
+  auto push_back(const value_type& value) {
+    return indexed(tree.push_back(value));
+  }
+  auto push_back(value_type&& value) {
+    return indexed(tree.push_back(std::move(value)));
+  }
+  template <class InputIterator>
+  void append(InputIterator first, InputIterator last) {
+    while (first != last)
+      push_back(*first++);
   }
   template <class InputIterator>
   void insert(InputIterator first, InputIterator last) {
     while (first != last)
-      tree.insert(*first++);
+      insert(*first++);
   }
   void insert(std::initializer_list<value_type> init) {
     for (auto&& e : init)
-      tree.insert(e);
+      insert(e);
   }
   template <class... Args>
   auto emplace(Args&&... args) {
@@ -133,31 +211,69 @@ public:
     return insert(hint, value_type(std::forward<Args>(args)...));
   }
   iterator erase(const_iterator pos) {
+    if constexpr (hashed)
+      index.erase(pos);
     return tree.erase(pos);
   }
   iterator erase(const_iterator first, const_iterator last) {
-    while (first != last)
-      tree.erase(first++);
-    return iterator(last.node);
+    if constexpr (hashed)
+      for (const_iterator i = first; i != last; ++i)
+        index.erase(i);
+    return tree.erase(first, last);
   }
   size_type erase(const Key& key) {
-    auto p = tree.equal_range(key);
-    const size_type old_size = tree.size();
-    while (p.first != p.second)
-      tree.erase(p.first++);
-    return old_size - tree.size();
+    if constexpr (hashed) {
+      NodeBase* const x = index.find(key);
+      if (x)
+        erase(const_iterator(x));
+      return x != nullptr;
+    } else
+      return tree.erase(key);
+  }
+  size_type pop_front(size_type n = 1) {
+    n = std::min(n, size());
+    erase(cbegin(), std::next(cbegin(), n));
+    return n;
+  }
+  template <class Pred>
+  friend size_type erase_if(BasicSet& set, Pred pred) {
+    return set.tree.erase_if(
+        [&](const const_iterator i) { return pred(*i); },
+        [&](const const_iterator i) {
+          if constexpr (hashed)
+            set.index.erase(i);
+        });
   }
   void swap(BasicSet& other) {
     std::swap(*this, other);
   }
   iterator find(const Key& key) {
-    return tree.find(key);
+    if constexpr (hashed) {
+      NodeBase* const x = index.find(key);
+      return x ? iterator(x) : end();
+    } else
+      return tree.find(key);
   }
   const_iterator find(const Key& key) const {
-    return tree.find(key);
+    if constexpr (hashed) {
+      NodeBase* const x = index.find(key);
+      return x ? const_iterator(x) : end();
+    } else
+      return tree.find(key);
   }
   size_type count(const Key& key) const {
-    return tree.count(key);
+    if constexpr (hashed)
+      return index.find(key) != nullptr;
+    else
+      return tree.count(key);
+  }
+  bool contains(const Key& key) const {
+    return find(key) != end();
+  }
+  std::size_t index_memory() const
+  requires hashed
+  {
+    return index.memory();
   }
   std::pair<iterator, iterator> equal_range(const Key& key) {
     return tree.equal_range(key);
@@ -177,12 +293,120 @@ public:
   const_iterator lower_bound(const Key& key) const {
     return tree.lower_bound(key);
   }
+  iterator lower_bound_from(const_iterator pos, const Key& key) {
+    return tree.lower_bound_from(pos, key);
+  }
+  const_iterator lower_bound_from(const_iterator pos, const Key& key) const {
+    return tree.lower_bound_from(pos, key);
+  }
+  iterator upper_bound_from(const_iterator pos, const Key& key) {
+    return tree.upper_bound_from(pos, key);
+  }
+  const_iterator upper_bound_from(const_iterator pos, const Key& key) const {
+    return tree.upper_bound_from(pos, key);
+  }
+  iterator find_from(const_iterator pos, const Key& key) {
+    return tree.find_from(pos, key);
+  }
+  const_iterator find_from(const_iterator pos, const Key& key) const {
+    return tree.find_from(pos, key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  iterator find(const K& key) {
+    return tree.find(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  const_iterator find(const K& key) const {
+    return tree.find(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  size_type count(const K& key) const {
+    return tree.count(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  std::pair<iterator, iterator> equal_range(const K& key) {
+    return tree.equal_range(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  std::pair<const_iterator, const_iterator> equal_range(const K& key) const {
+    return tree.equal_range(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  iterator upper_bound(const K& key) {
+    return tree.upper_bound(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  const_iterator upper_bound(const K& key) const {
+    return tree.upper_bound(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  iterator lower_bound(const K& key) {
+    return tree.lower_bound(key);
+  }
+  template <class K>
+  requires Transparent<Compare>
+  const_iterator lower_bound(const K& key) const {
+    return tree.lower_bound(key);
+  }
   value_compare value_comp() const {
     return tree.key_comp();
   }
   value_compare key_comp() const {
     return tree.key_comp();
   }
+  using summary_type = Augment::value_type;
+  summary_type aggregate() const {
+    return tree.aggregate();
+  }
+  summary_type aggregate(const_iterator first, const_iterator last) const {
+    return tree.aggregate(first, last);
+  }
+  summary_type aggregate(const Key& lo, const Key& hi) const {
+    return tree.aggregate(tree.lower_bound(lo), tree.lower_bound(hi));
+  }
+  template <class Pred>
+  const_iterator prefix_search(Pred pred) const {
+    return tree.prefix_search(pred);
+  }
+  template <class F>
+  void diff(const BasicSet& other, F f) const
+  requires AreKeysUnique
+  {
+    tree.diff(other.tree, f);
+  }
+  std::vector<std::pair<const_iterator, const_iterator>>
+  split_ranges(std::size_t n) const {
+    return tree.split_ranges(tree.begin(), tree.end(), n);
+  }
+  std::vector<std::pair<const_iterator, const_iterator>>
+  split_ranges(const_iterator first, const_iterator last, std::size_t n) const {
+    return tree.split_ranges(first, last, n);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, F f) {
+    tree.parallel_for_each(policy, begin(), end(), f);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, F f) const {
+    tree.parallel_for_each(policy, begin(), end(), f);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, iterator first, iterator last, F f) {
+    tree.parallel_for_each(policy, first, last, f);
+  }
+  template <class F>
+  void parallel_for_each(Parallel policy, const_iterator first,
+                         const_iterator last, F f) const {
+    tree.parallel_for_each(policy, first, last, f);
+  }
   bool operator==(const BasicSet& other) {
     return tree == other.tree;
   }
@@ -195,5 +419,22 @@ template <class Key, class Compare = std::less<Key>>
 using Set = BasicSet<Key, Compare, true>;
 template <class Key, class Compare = std::less<Key>>
 using MultiSet = BasicSet<Key, Compare, false>;
+template <class Key, class Compare = std::less<Key>>
+using MerkleSet = BasicSet<Key, Compare, true, MerkleHash>;
+template <class Key, class Monoid, class Compare = std::less<Key>>
+using AugmentedSet = BasicSet<Key, Compare, true, Monoid>;
+template <class Key, class Monoid, class Compare = std::less<Key>>
+using AugmentedMultiSet = BasicSet<Key, Compare, false, Monoid>;
+template <class Key, class Compare = std::less<Key>>
+using AvlSet = BasicSet<Key, Compare, true, NoAugment, Avl>;
+template <class Key, class Compare = std::less<Key>>
+using TreapSet = BasicSet<Key, Compare, true, NoAugment, Treap>;
+template <class Key, class Compare = std::less<Key>>
+using SplaySet = BasicSet<Key, Compare, true, NoAugment, Splay>;
+template <class Key, std::size_t N = 16, class Compare = std::less<Key>>
+using SmallSet = BasicSet<Key, Compare, true, NoAugment, RedBlack, N>;
+template <class Key, class Compare = std::less<Key>>
+using HashedSet =
+    BasicSet<Key, Compare, true, NoAugment, RedBlack, 0, HashIndex>;
 
 #endif
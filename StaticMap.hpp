@@ -0,0 +1,145 @@
+#ifndef STATIC_MAP_HPP
+#define STATIC_MAP_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+template <class Key, class T, std::size_t N, class Compare = std::less<Key>>
+class StaticMap {
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using key_compare = Compare;
+  using reference = const value_type&;
+  using const_reference = const value_type&;
+  using iterator = const value_type*;
+  using const_iterator = const value_type*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  std::array<value_type, N> entries{};
+  std::size_t used = 0;
+  [[no_unique_address]] Compare comp;
+
+  template <class InputIterator>
+  constexpr void build(InputIterator first, InputIterator last) {
+    for (; first != last; ++first) {
+      if (used == N)
+        throw std::length_error("StaticMap: more entries than capacity");
+      std::size_t i = used++;
+      entries[i] = *first;
+      for (; i > 0 && comp(entries[i].first, entries[i - 1].first); --i)
+        std::swap(entries[i], entries[i - 1]);
+    }
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < used; ++i)
+      if (size == 0 || comp(entries[size - 1].first, entries[i].first)) {
+        if (size != i)
+          entries[size] = std::move(entries[i]);
+        ++size;
+      }
+    used = size;
+  }
+
+  template <class Before>
+  constexpr const_iterator search(Before before) const {
+    if (!used)
+      return end();
+    const_iterator base = begin();
+    for (std::size_t n = used; n > 1; n -= n / 2)
+      base = before(base[n / 2]) ? base + n / 2 : base;
+    return base + before(*base);
+  }
+
+public:
+  constexpr StaticMap() = default;
+  constexpr StaticMap(std::initializer_list<value_type> init,
+                      const Compare& comp = Compare()) :
+      comp(comp) {
+    build(init.begin(), init.end());
+  }
+  constexpr StaticMap(const value_type (&init)[N],
+                      const Compare& comp = Compare()) :
+      comp(comp) {
+    build(std::begin(init), std::end(init));
+  }
+
+  constexpr const_iterator begin() const {
+    return entries.data();
+  }
+  constexpr const_iterator cbegin() const {
+    return begin();
+  }
+  constexpr const_iterator end() const {
+    return entries.data() + used;
+  }
+  constexpr const_iterator cend() const {
+    return end();
+  }
+  constexpr const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  constexpr const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  constexpr bool empty() const {
+    return used == 0;
+  }
+  constexpr size_type size() const {
+    return used;
+  }
+  static constexpr size_type max_size() {
+    return N;
+  }
+  constexpr const_iterator lower_bound(const Key& key) const {
+    return search([&](const value_type& e) { return comp(e.first, key); });
+  }
+  constexpr const_iterator upper_bound(const Key& key) const {
+    return search([&](const value_type& e) { return !comp(key, e.first); });
+  }
+  constexpr std::pair<const_iterator, const_iterator>
+  equal_range(const Key& key) const {
+    const const_iterator i = lower_bound(key);
+    if (i == end() || comp(key, i->first))
+      return {i, i};
+    return {i, i + 1};
+  }
+  constexpr const_iterator find(const Key& key) const {
+    const const_iterator i = lower_bound(key);
+    return i == end() || comp(key, i->first) ? end() : i;
+  }
+  constexpr size_type count(const Key& key) const {
+    return find(key) != end();
+  }
+  constexpr bool contains(const Key& key) const {
+    return find(key) != end();
+  }
+  constexpr const mapped_type& at(const Key& key) const {
+    return find(key)->second;
+  }
+  constexpr key_compare key_comp() const {
+    return comp;
+  }
+  constexpr bool operator==(const StaticMap& other) const {
+    return std::equal(begin(), end(), other.begin(), other.end());
+  }
+};
+
+template <class Key, class T, class Compare = std::less<Key>, std::size_t N>
+constexpr StaticMap<Key, T, N, Compare>
+make_static_map(const std::pair<Key, T> (&entries)[N],
+                const Compare& comp = Compare()) {
+  return StaticMap<Key, T, N, Compare>(entries, comp);
+}
+
+#endif
@@ -1,7 +1,21 @@
 #ifndef STL_TREE_H
 #define STL_TREE_H
 
+#include <algorithm>
+#include <atomic>
+#include <compare>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <cstdint>
+#include <exception>
+#include <functional>
 #include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
 namespace {
 enum class Color : bool {
@@ -11,6 +25,8 @@ enum class Color : bool {
 
 struct NodeBase {
   Color color;
+  bool pooled = false;
+  std::uint32_t rank;
   NodeBase* parent;
   NodeBase* left;
   NodeBase* right;
@@ -30,11 +46,90 @@ struct NodeBase {
   }
 };
 
-template <class Val>
+struct NoAugment {
+  struct value_type {};
+
+  static constexpr value_type identity() {
+    return {};
+  }
+
+  static constexpr value_type lift(const auto&) {
+    return {};
+  }
+
+  static constexpr value_type combine(value_type, value_type) {
+    return {};
+  }
+};
+
+struct NoKeyCache {
+  NoKeyCache() = default;
+  NoKeyCache(const auto&) {}
+
+  constexpr bool operator==(const NoKeyCache&) const {
+    return true;
+  }
+
+  constexpr std::strong_ordering operator<=>(const NoKeyCache&) const {
+    return std::strong_ordering::equal;
+  }
+};
+
+struct StringPrefix {
+  std::uint64_t prefix;
+
+  StringPrefix() = default;
+  StringPrefix(std::string_view s) {
+    unsigned char bytes[sizeof(prefix)] = {};
+    std::memcpy(bytes, s.data(), std::min(s.size(), sizeof(prefix)));
+    std::memcpy(&prefix, bytes, sizeof(prefix));
+    if constexpr (std::endian::native == std::endian::little)
+      prefix = std::byteswap(prefix);
+  }
+
+  bool operator==(const StringPrefix&) const = default;
+  auto operator<=>(const StringPrefix&) const = default;
+};
+
+template <class Key, class Compare>
+using KeyCacheFor =
+    std::conditional_t<std::is_same_v<Key, std::string> &&
+                           (std::is_same_v<Compare, std::less<Key>> ||
+                            std::is_same_v<Compare, std::less<>>),
+                       StringPrefix, NoKeyCache>;
+
+struct NodeChunk {
+  static constexpr std::size_t bytes = std::size_t(1) << 16;
+
+  std::size_t live;
+
+  static NodeChunk* allocate() {
+    NodeChunk* c = static_cast<NodeChunk*>(
+        ::operator new(bytes, std::align_val_t(bytes)));
+    c->live = 0;
+    return c;
+  }
+
+  static void release(const void* p) {
+    NodeChunk* c = reinterpret_cast<NodeChunk*>(
+        reinterpret_cast<std::uintptr_t>(p) & ~(bytes - 1));
+    if (--c->live == 0)
+      ::operator delete(c, std::align_val_t(bytes));
+  }
+};
+
+template <class Val, class Augment = NoAugment, class KeyCache = NoKeyCache>
 struct Node : NodeBase {
+  using value_type = Val;
+  using Summary = Augment::value_type;
+  static constexpr bool augmented = !std::is_same_v<Augment, NoAugment>;
+  static constexpr bool cached = !std::is_same_v<KeyCache, NoKeyCache>;
+
   template <class... Args>
   Node(Args&&... args) : val(std::forward<Args>(args)...) {}
+  [[no_unique_address]] KeyCache cache;
   Val val;
+  [[no_unique_address]] Summary summary;
 
   static constexpr auto up_cast(NodeBase* base) {
     return reinterpret_cast<Node*>(base);
@@ -44,26 +139,82 @@ struct Node : NodeBase {
     return reinterpret_cast<const Node*>(base);
   }
 
-  static void deep_erase(Node* x) {
+  static Summary summary_of(const NodeBase* x) {
+    return x ? up_cast(x)->summary : Augment::identity();
+  }
+
+  static Summary combined(const NodeBase* x) {
+    return Augment::combine(
+        Augment::combine(summary_of(x->left), Augment::lift(up_cast(x)->val)),
+        summary_of(x->right));
+  }
+
+  static void update(NodeBase* x) {
+    if constexpr (augmented)
+      up_cast(x)->summary = combined(x);
+  }
+
+  static void destroy(Node* x) {
     if (!x)
       return;
-    deep_erase(up_cast(x->left));
-    deep_erase(up_cast(x->right));
-    delete x;
+    if (!x->pooled)
+      delete x;
+    else {
+      x->~Node();
+      NodeChunk::release(x);
+    }
   }
 
-  static Node* deep_copy(Node* x, NodeBase* parent) {
-    if (!x)
-      return nullptr;
-    Node* node = new Node(x->val);
+  static std::size_t deep_erase(Node* x) {
+    std::size_t count = 0;
+    while (x)
+      if (NodeBase* y = x->left) {
+        x->left = y->right;
+        y->right = x;
+        x = up_cast(y);
+      } else {
+        Node* const next = up_cast(x->right);
+        destroy(x);
+        x = next;
+        ++count;
+      }
+    return count;
+  }
+
+  template <class Gen>
+  static Node* clone(const Node* x, NodeBase* parent, Gen& gen) {
+    Node* node = gen(x->val);
     node->parent = parent;
-    node->right = deep_copy(up_cast(x->right), node);
-    node->left = deep_copy(up_cast(x->left), node);
+    node->left = node->right = nullptr;
     node->color = x->color;
+    node->rank = x->rank;
+    node->cache = x->cache;
+    node->summary = x->summary;
     return node;
   }
+
+  template <class Gen>
+  static Node* deep_copy(const Node* x, NodeBase* parent, Gen&& gen) {
+    if (!x)
+      return nullptr;
+    Node* const top = clone(x, parent, gen);
+    const NodeBase* from = x;
+    NodeBase* to = top;
+    while (true)
+      if (from->left && !to->left) {
+        to->left = clone(up_cast(from->left), to, gen);
+        from = from->left, to = to->left;
+      } else if (from->right && !to->right) {
+        to->right = clone(up_cast(from->right), to, gen);
+        from = from->right, to = to->right;
+      } else if (from != x)
+        from = from->parent, to = to->parent;
+      else
+        return top;
+  }
 };
 
+template <class Node>
 void rotate_left(NodeBase* x, NodeBase*& root) {
   NodeBase* const y = x->right;
   x->right = y->left;
@@ -79,8 +230,11 @@ void rotate_left(NodeBase* x, NodeBase*& root) {
     x->parent->right = y;
   y->left = x;
   x->parent = y;
+  Node::update(x);
+  Node::update(y);
 }
 
+template <class Node>
 void rotate_right(NodeBase* x, NodeBase*& root) {
   NodeBase* const y = x->left;
   x->left = y->right;
@@ -96,11 +250,362 @@ void rotate_right(NodeBase* x, NodeBase*& root) {
     x->parent->left = y;
   y->right = x;
   x->parent = y;
+  Node::update(x);
+  Node::update(y);
 }
 
-template <class Val>
+template <class Node>
+void insert_fixup(NodeBase* x, NodeBase*& root) {
+  while (x != root && x->parent->color == Color::Red) {
+    NodeBase* const xpp = x->parent->parent;
+    if (x->parent == xpp->left) {
+      NodeBase* const y = xpp->right;
+      if (y && y->color == Color::Red) {
+        x->parent->color = Color::Black;
+        y->color = Color::Black;
+        xpp->color = Color::Red;
+        x = xpp;
+      } else {
+        if (x == x->parent->right) {
+          x = x->parent;
+          rotate_left<Node>(x, root);
+        }
+        x->parent->color = Color::Black;
+        xpp->color = Color::Red;
+        rotate_right<Node>(xpp, root);
+      }
+    } else {
+      NodeBase* const y = xpp->left;
+      if (y && y->color == Color::Red) {
+        x->parent->color = Color::Black;
+        y->color = Color::Black;
+        xpp->color = Color::Red;
+        x = xpp;
+      } else {
+        if (x == x->parent->left) {
+          x = x->parent;
+          rotate_right<Node>(x, root);
+        }
+        x->parent->color = Color::Black;
+        xpp->color = Color::Red;
+        rotate_left<Node>(xpp, root);
+      }
+    }
+  }
+}
+
+template <class Node>
+void erase_fixup(NodeBase* x, NodeBase* x_parent, NodeBase*& root) {
+  while (x != root && (!x || x->color == Color::Black))
+    if (x == x_parent->left) {
+      NodeBase* w = x_parent->right;
+      if (w->color == Color::Red) {
+        w->color = Color::Black;
+        x_parent->color = Color::Red;
+        rotate_left<Node>(x_parent, root);
+        w = x_parent->right;
+      }
+      if ((!w->left || w->left->color == Color::Black) &&
+          (!w->right || w->right->color == Color::Black)) {
+        w->color = Color::Red;
+        x = x_parent;
+        x_parent = x_parent->parent;
+      } else {
+        if (!w->right || w->right->color == Color::Black) {
+          w->left->color = Color::Black;
+          w->color = Color::Red;
+          rotate_right<Node>(w, root);
+          w = x_parent->right;
+        }
+        w->color = x_parent->color;
+        x_parent->color = Color::Black;
+        if (w->right)
+          w->right->color = Color::Black;
+        rotate_left<Node>(x_parent, root);
+        break;
+      }
+    } else {
+      NodeBase* w = x_parent->left;
+      if (w->color == Color::Red) {
+        w->color = Color::Black;
+        x_parent->color = Color::Red;
+        rotate_right<Node>(x_parent, root);
+        w = x_parent->left;
+      }
+      if ((!w->right || w->right->color == Color::Black) &&
+          (!w->left || w->left->color == Color::Black)) {
+        w->color = Color::Red;
+        x = x_parent;
+        x_parent = x_parent->parent;
+      } else {
+        if (!w->left || w->left->color == Color::Black) {
+          w->right->color = Color::Black;
+          w->color = Color::Red;
+          rotate_left<Node>(w, root);
+          w = x_parent->left;
+        }
+        w->color = x_parent->color;
+        x_parent->color = Color::Black;
+        if (w->left)
+          w->left->color = Color::Black;
+        rotate_right<Node>(x_parent, root);
+        break;
+      }
+    }
+  if (x)
+    x->color = Color::Black;
+}
+
+struct Subtree {
+  NodeBase* root;
+  std::size_t black_height;
+};
+
+std::size_t black_height(const NodeBase* x) {
+  std::size_t height = 0;
+  for (; x; x = x->left)
+    height += x->color == Color::Black;
+  return height;
+}
+
+template <class Node>
+Subtree join(Subtree l, NodeBase* k, Subtree r) {
+  if (l.root && l.root->color == Color::Red) {
+    l.root->color = Color::Black;
+    ++l.black_height;
+  }
+  if (r.root && r.root->color == Color::Red) {
+    r.root->color = Color::Black;
+    ++r.black_height;
+  }
+
+  if (l.black_height == r.black_height) {
+    k->left = l.root;
+    k->right = r.root;
+    if (l.root)
+      l.root->parent = k;
+    if (r.root)
+      r.root->parent = k;
+    k->color = Color::Black;
+    Node::update(k);
+    return {k, l.black_height + 1};
+  }
+
+  const bool taller_left = l.black_height > r.black_height;
+  Subtree t = taller_left ? l : r;
+  const std::size_t target = taller_left ? r.black_height : l.black_height;
+  std::size_t height = t.black_height;
+  NodeBase* p = nullptr;
+  NodeBase* c = t.root;
+  while (height != target || (c && c->color == Color::Red)) {
+    height -= c->color == Color::Black;
+    p = c;
+    c = taller_left ? c->right : c->left;
+  }
+
+  if (taller_left) {
+    k->left = c;
+    k->right = r.root;
+    p->right = k;
+    if (r.root)
+      r.root->parent = k;
+  } else {
+    k->left = l.root;
+    k->right = c;
+    p->left = k;
+    if (l.root)
+      l.root->parent = k;
+  }
+  if (c)
+    c->parent = k;
+  k->parent = p;
+  k->color = Color::Red;
+  if constexpr (Node::augmented)
+    for (NodeBase* y = k;; y = y->parent) {
+      Node::update(y);
+      if (y == t.root)
+        break;
+    }
+
+  insert_fixup<Node>(k, t.root);
+  if (t.root->color == Color::Red) {
+    t.root->color = Color::Black;
+    ++t.black_height;
+  }
+  return t;
+}
+
+template <class Node>
+std::pair<Subtree, Subtree> split(NodeBase* n, const NodeBase* stop) {
+  std::size_t height = black_height(n);
+  const std::size_t child_height = height - (n->color == Color::Black);
+  Subtree l{n->left, child_height};
+  Subtree r{n->right, child_height};
+
+  NodeBase* c = n;
+  NodeBase* a = n->parent;
+  while (a != stop) {
+    NodeBase* const next = a->parent;
+    const std::size_t parent_height = height + (a->color == Color::Black);
+    if (c == a->left)
+      r = join<Node>(r, a, {a->right, height});
+    else
+      l = join<Node>({a->left, height}, a, l);
+    height = parent_height;
+    c = a;
+    a = next;
+  }
+  return {l, r};
+}
+
+struct RedBlack {
+  template <class Node>
+  static void insert(NodeBase* x, NodeBase& header) {
+    x->color = Color::Red;
+    insert_fixup<Node>(x, header.parent);
+    header.parent->color = Color::Black;
+  }
+
+  template <class Node>
+  static void erase(NodeBase* removed, NodeBase* x, NodeBase* x_parent,
+                    NodeBase& header) {
+    if (removed->color != Color::Red)
+      erase_fixup<Node>(x, x_parent, header.parent);
+  }
+
+  template <class Node>
+  static void access(NodeBase*, NodeBase&) {}
+};
+
+struct Avl {
+  static std::uint32_t height(const NodeBase* x) {
+    return x ? x->rank : 0;
+  }
+
+  static void fix_height(NodeBase* x) {
+    x->rank = std::max(height(x->left), height(x->right)) + 1;
+  }
+
+  template <class Node>
+  static void retrace(NodeBase* x, NodeBase& header) {
+    for (; x != &header; x = x->parent) {
+      if (height(x->left) > height(x->right) + 1) {
+        NodeBase* const l = x->left;
+        if (height(l->left) < height(l->right)) {
+          rotate_left<Node>(l, header.parent);
+          fix_height(l);
+        }
+        rotate_right<Node>(x, header.parent);
+        fix_height(x);
+        x = x->parent;
+      } else if (height(x->right) > height(x->left) + 1) {
+        NodeBase* const r = x->right;
+        if (height(r->right) < height(r->left)) {
+          rotate_right<Node>(r, header.parent);
+          fix_height(r);
+        }
+        rotate_left<Node>(x, header.parent);
+        fix_height(x);
+        x = x->parent;
+      }
+      fix_height(x);
+    }
+  }
+
+  template <class Node>
+  static void insert(NodeBase* x, NodeBase& header) {
+    x->color = Color::Black;
+    retrace<Node>(x, header);
+  }
+
+  template <class Node>
+  static void erase(NodeBase*, NodeBase*, NodeBase* x_parent,
+                    NodeBase& header) {
+    retrace<Node>(x_parent, header);
+  }
+
+  template <class Node>
+  static void access(NodeBase*, NodeBase&) {}
+};
+
+struct Treap {
+  static std::uint32_t priority() {
+    thread_local std::uint32_t state = 0x9e3779b9;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
+
+  template <class Node>
+  static void insert(NodeBase* x, NodeBase& header) {
+    x->color = Color::Black;
+    x->rank = priority();
+    while (x->parent != &header && x->parent->rank < x->rank)
+      if (x == x->parent->left)
+        rotate_right<Node>(x->parent, header.parent);
+      else
+        rotate_left<Node>(x->parent, header.parent);
+  }
+
+  template <class Node>
+  static void erase(NodeBase*, NodeBase*, NodeBase*, NodeBase&) {}
+
+  template <class Node>
+  static void access(NodeBase*, NodeBase&) {}
+};
+
+struct Splay {
+  template <class Node>
+  static void splay(NodeBase* x, NodeBase& header) {
+    NodeBase*& root = header.parent;
+    while (x != root) {
+      NodeBase* const p = x->parent;
+      if (p == root) {
+        if (x == p->left)
+          rotate_right<Node>(p, root);
+        else
+          rotate_left<Node>(p, root);
+        continue;
+      }
+      NodeBase* const g = p->parent;
+      if (x == p->left && p == g->left) {
+        rotate_right<Node>(g, root);
+        rotate_right<Node>(p, root);
+      } else if (x == p->right && p == g->right) {
+        rotate_left<Node>(g, root);
+        rotate_left<Node>(p, root);
+      } else if (x == p->left) {
+        rotate_right<Node>(p, root);
+        rotate_left<Node>(g, root);
+      } else {
+        rotate_left<Node>(p, root);
+        rotate_right<Node>(g, root);
+      }
+    }
+  }
+
+  template <class Node>
+  static void insert(NodeBase* x, NodeBase& header) {
+    x->color = Color::Black;
+    splay<Node>(x, header);
+  }
+
+  template <class Node>
+  static void erase(NodeBase*, NodeBase*, NodeBase* x_parent,
+                    NodeBase& header) {
+    if (x_parent != &header)
+      splay<Node>(x_parent, header);
+  }
+
+  template <class Node>
+  static void access(NodeBase* x, NodeBase& header) {
+    splay<Node>(x, header);
+  }
+};
+
+template <class Node, class Balance>
 struct Header {
-  using Node = ::Node<Val>;
 
   NodeBase super_root;
   std::size_t node_count;
@@ -113,7 +618,12 @@ struct Header {
   }
 
   Header(const Header& x) {
-    root() = Node::deep_copy(Node::up_cast(x.root()), &super_root);
+    copy(x, [](const auto& v) { return new Node(v); });
+  }
+
+  template <class Gen>
+  void copy(const Header& x, Gen&& gen) {
+    root() = Node::deep_copy(Node::up_cast(x.root()), &super_root, gen);
     if (root()) {
       root()->parent = &super_root;
       leftmost() = root()->minimum();
@@ -161,6 +671,13 @@ struct Header {
     new (this) Header();
   }
 
+  NodeBase* release() {
+    NodeBase* const x = root();
+    root() = nullptr;
+    clear();
+    return x;
+  }
+
   auto&& root(this auto&& self) {
     return self.super_root.parent;
   }
@@ -173,10 +690,57 @@ struct Header {
     return self.super_root.right;
   }
 
+  static NodeBase* build(NodeBase* const* nodes, std::size_t n,
+                         NodeBase* parent, std::size_t depth,
+                         std::size_t red_depth, std::size_t threads = 1) {
+    if (!n)
+      return nullptr;
+    NodeBase* const x = nodes[n / 2];
+    x->parent = parent;
+    if (threads > 1) {
+      std::thread left([=] {
+        x->left = build(nodes, n / 2, x, depth + 1, red_depth, threads / 2);
+      });
+      x->right = build(nodes + n / 2 + 1, n - n / 2 - 1, x, depth + 1,
+                       red_depth, threads - threads / 2);
+      left.join();
+    } else {
+      x->left = build(nodes, n / 2, x, depth + 1, red_depth);
+      x->right =
+          build(nodes + n / 2 + 1, n - n / 2 - 1, x, depth + 1, red_depth);
+    }
+    x->color = std::is_same_v<Balance, RedBlack> && depth == red_depth
+                   ? ::Color::Red
+                   : ::Color::Black;
+    x->rank = std::max(x->left ? x->left->rank : 0,
+                       x->right ? x->right->rank : 0) + 1;
+    Node::update(x);
+    return x;
+  }
+
+  void link_sorted(NodeBase* const* nodes, std::size_t n,
+                   std::size_t threads = 1) {
+    root() =
+        build(nodes, n, &super_root, 0, std::bit_width(n + 1) - 1, threads);
+    leftmost() = n ? nodes[0] : &super_root;
+    rightmost() = n ? nodes[n - 1] : &super_root;
+    node_count = n;
+  }
+
+  void update_path(NodeBase* x) {
+    if constexpr (Node::augmented)
+      for (; x != &super_root; x = x->parent)
+        Node::update(x);
+  }
+
+  void access(NodeBase* x) {
+    if (x != &super_root)
+      Balance::template access<Node>(x, super_root);
+  }
+
   void insert(const bool insert_left, NodeBase* x, NodeBase* p) {
     x->parent = p;
     x->left = x->right = nullptr;
-    x->color = Color::Red;
 
     if (insert_left) {
       p->left = x;
@@ -191,47 +755,16 @@ struct Header {
         rightmost() = x;
     }
 
-    while (x != root() && x->parent->color == Color::Red) {
-      NodeBase* const xpp = x->parent->parent;
-      if (x->parent == xpp->left) {
-        NodeBase* const y = xpp->right;
-        if (y && y->color == Color::Red) {
-          x->parent->color = Color::Black;
-          y->color = Color::Black;
-          xpp->color = Color::Red;
-          x = xpp;
-        } else {
-          if (x == x->parent->right) {
-            x = x->parent;
-            rotate_left(x, root());
-          }
-          x->parent->color = Color::Black;
-          xpp->color = Color::Red;
-          rotate_right(xpp, root());
-        }
-      } else {
-        NodeBase* const y = xpp->left;
-        if (y && y->color == Color::Red) {
-          x->parent->color = Color::Black;
-          y->color = Color::Black;
-          xpp->color = Color::Red;
-          x = xpp;
-        } else {
-          if (x == x->parent->left) {
-            x = x->parent;
-            rotate_right(x, root());
-          }
-          x->parent->color = Color::Black;
-          xpp->color = Color::Red;
-          rotate_left(xpp, root());
-        }
-      }
-    }
-    root()->color = Color::Black;
+    update_path(x);
+    Balance::template insert<Node>(x, super_root);
     ++node_count;
   }
 
   void erase(NodeBase* z) {
+    Node::destroy(Node::up_cast(extract(z)));
+  }
+
+  NodeBase* extract(NodeBase* z) {
     NodeBase* y = z;
     NodeBase* x{};
     NodeBase* x_parent{};
@@ -266,6 +799,7 @@ struct Header {
         z->parent->right = y;
       y->parent = z->parent;
       std::swap(y->color, z->color);
+      std::swap(y->rank, z->rank);
       y = z;
 
     } else {
@@ -291,75 +825,143 @@ struct Header {
           rightmost() = x->maximum();
       }
     }
-    if (y->color != Color::Red) {
-      while (x != root() && (!x || x->color == Color::Black))
-        if (x == x_parent->left) {
-          NodeBase* w = x_parent->right;
-          if (w->color == Color::Red) {
-            w->color = Color::Black;
-            x_parent->color = Color::Red;
-            rotate_left(x_parent, root());
-            w = x_parent->right;
-          }
-          if ((!w->left || w->left->color == Color::Black) &&
-              (!w->right || w->right->color == Color::Black)) {
-            w->color = Color::Red;
-            x = x_parent;
-            x_parent = x_parent->parent;
-          } else {
-            if (!w->right || w->right->color == Color::Black) {
-              w->left->color = Color::Black;
-              w->color = Color::Red;
-              rotate_right(w, root());
-              w = x_parent->right;
-            }
-            w->color = x_parent->color;
-            x_parent->color = Color::Black;
-            if (w->right)
-              w->right->color = Color::Black;
-            rotate_left(x_parent, root());
-            break;
-          }
-        } else {
-          NodeBase* w = x_parent->left;
-          if (w->color == Color::Red) {
-            w->color = Color::Black;
-            x_parent->color = Color::Red;
-            rotate_right(x_parent, root());
-            w = x_parent->left;
-          }
-          if ((!w->right || w->right->color == Color::Black) &&
-              (!w->left || w->left->color == Color::Black)) {
-            w->color = Color::Red;
-            x = x_parent;
-            x_parent = x_parent->parent;
-          } else {
-            if (!w->left || w->left->color == Color::Black) {
-              w->right->color = Color::Black;
-              w->color = Color::Red;
-              rotate_left(w, root());
-              w = x_parent->left;
-            }
-            w->color = x_parent->color;
-            x_parent->color = Color::Black;
-            if (w->left)
-              w->left->color = Color::Black;
-            rotate_right(x_parent, root());
-            break;
-          }
-        }
-      if (x)
-        x->color = Color::Black;
+    update_path(x_parent);
+    Balance::template erase<Node>(y, x, x_parent, super_root);
+    --node_count;
+    return y;
+  }
+
+  void erase(NodeBase* first, NodeBase* last) {
+    Subtree after{nullptr, 0};
+    if (last != &super_root) {
+      auto [before, rest] = split<Node>(last, &super_root);
+      root() = before.root;
+      root()->parent = &super_root;
+      after = rest;
     }
 
-    delete Node::up_cast(y);
-    --node_count;
+    auto [kept, dropped] = split<Node>(first, &super_root);
+    std::size_t erased = Node::deep_erase(Node::up_cast(dropped.root));
+    Node::destroy(Node::up_cast(first));
+    ++erased;
+
+    Subtree t = last != &super_root ? join<Node>(kept, last, after) : kept;
+    root() = t.root;
+    if (!t.root)
+      return clear();
+    root()->parent = &super_root;
+    root()->color = Color::Black;
+    leftmost() = root()->minimum();
+    rightmost() = root()->maximum();
+    node_count -= erased;
+  }
+
+  // Returns the black height under RedBlack and the height otherwise, or -1
+  // if a parent link, the balance rule or a summary is wrong below x.
+  static std::ptrdiff_t verify(const NodeBase* x, bool balanced,
+                               std::size_t& count) {
+    if (!x)
+      return 0;
+    ++count;
+    for (const NodeBase* c : {x->left, x->right})
+      if (c && c->parent != x)
+        return -1;
+    const std::ptrdiff_t l = verify(x->left, balanced, count);
+    const std::ptrdiff_t r = verify(x->right, balanced, count);
+    if (l < 0 || r < 0)
+      return -1;
+    if constexpr (Node::augmented)
+      if constexpr (requires(const typename Node::Summary& s) { s == s; })
+        if (!(Node::up_cast(x)->summary == Node::combined(x)))
+          return -1;
+    if (balanced) {
+      if constexpr (std::is_same_v<Balance, RedBlack>) {
+        const auto red = [](const NodeBase* c) {
+          return c && c->color == ::Color::Red;
+        };
+        if (l != r || (red(x) && (red(x->left) || red(x->right))))
+          return -1;
+        return l + (x->color == ::Color::Black);
+      } else if constexpr (std::is_same_v<Balance, Avl>) {
+        if (std::ptrdiff_t(x->rank) != std::max(l, r) + 1 || l > r + 1 ||
+            r > l + 1)
+          return -1;
+      } else if constexpr (std::is_same_v<Balance, Treap>) {
+        for (const NodeBase* c : {x->left, x->right})
+          if (c && c->rank > x->rank)
+            return -1;
+      }
+    }
+    return std::max(l, r) + 1;
+  }
+
+  // The inline slots of the small mode form a chain, so they are checked
+  // with balanced = false.
+  bool verify(bool balanced = true) const {
+    if (super_root.color != ::Color::Red)
+      return false;
+    NodeBase* const x = root();
+    if (!x)
+      return node_count == 0 && leftmost() == &super_root &&
+             rightmost() == &super_root;
+    std::size_t count = 0;
+    if (x->parent != &super_root || verify(x, balanced, count) < 0)
+      return false;
+    if constexpr (std::is_same_v<Balance, RedBlack>)
+      if (balanced && x->color != ::Color::Black)
+        return false;
+    return count == node_count && leftmost() == x->minimum() &&
+           rightmost() == x->maximum();
+  }
+};
+
+template <class F>
+void run_parallel(std::size_t threads, F f) {
+  // Every worker is joined before the first exception is rethrown, so the
+  // caller can clean up once nothing runs any more.
+  std::vector<std::exception_ptr> errors(std::max<std::size_t>(threads, 1));
+  const auto guarded = [&](std::size_t i) {
+    try {
+      f(i);
+    } catch (...) {
+      errors[i] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> workers;
+  try {
+    for (std::size_t i = 1; i < threads; ++i)
+      workers.emplace_back(guarded, i);
+  } catch (...) {
+    errors[0] = std::current_exception();
+  }
+  if (!errors[0])
+    guarded(0);
+  for (std::thread& w : workers)
+    w.join();
+  for (const std::exception_ptr& e : errors)
+    if (e)
+      std::rethrow_exception(e);
+}
+
+template <class Node, std::size_t N>
+struct InlineNodes {
+  alignas(Node) std::byte bytes[N * sizeof(Node)];
+  bool spilled = false;
+
+  Node* slot(std::size_t i) {
+    return reinterpret_cast<Node*>(bytes) + i;
   }
 };
 
-template <bool Const, class Val>
+template <class Node>
+struct InlineNodes<Node, 0> {
+  static constexpr bool spilled = true;
+};
+
+template <bool Const, class Node>
 struct iterator {
-  using value_type = std::conditional_t<Const, const Val, Val>;
+  using value_type = std::conditional_t<Const, const typename Node::value_type,
+                                        typename Node::value_type>;
   using reference = value_type&;
   using pointer = value_type*;
   using iterator_category = std::bidirectional_iterator_tag;
@@ -373,16 +975,16 @@ struct iterator {
   iterator(const iterator&) = default;
   iterator& operator=(const iterator&) = default;
 
-  constexpr iterator(const iterator<false, Val>& it)
+  constexpr iterator(const iterator<false, Node>& it)
   requires Const
       : node(it.node) {}
 
   reference operator*() const {
-    return Node<Val>::up_cast(node)->val;
+    return Node::up_cast(node)->val;
   }
 
   pointer operator->() const {
-    return &Node<Val>::up_cast(node)->val;
+    return &Node::up_cast(node)->val;
   }
 
   constexpr iterator& operator++() {
@@ -436,16 +1038,191 @@ struct iterator {
 
   bool operator==(const iterator& y) const = default;
 };
+
+template <class T>
+std::size_t hash_value(const T& v) {
+  return std::hash<T>()(v);
+}
+
+template <class T, class U>
+std::size_t hash_value(const std::pair<T, U>& v) {
+  const std::size_t h = hash_value(v.first);
+  return h ^ (hash_value(v.second) + 0x9e3779b97f4a7c15 + (h << 6) + (h >> 2));
+}
 } // namespace
 
-template <class Key, class Val, class Hasher, class Compare, bool UniqueKeys>
+struct Parallel {
+  std::size_t threads = std::thread::hardware_concurrency();
+};
+
+struct MerkleHash {
+  struct value_type {
+    std::uint64_t hash;
+    std::uint64_t power;
+    bool operator==(const value_type&) const = default;
+  };
+
+  static constexpr std::uint64_t base = 0x100000001b3;
+
+  static constexpr value_type identity() {
+    return {0, 1};
+  }
+
+  static value_type lift(const auto& v) {
+    return {hash_value(v), base};
+  }
+
+  static constexpr value_type combine(value_type lhs, value_type rhs) {
+    return {lhs.hash * rhs.power + rhs.hash, lhs.power * rhs.power};
+  }
+};
+
+struct NoIndex {};
+struct HashIndex {};
+
+template <class Key, class Iterator, class KeyOf, class Index>
+class NodeIndex {
+public:
+  static constexpr bool enabled = false;
+};
+
+template <class Key, class Iterator, class KeyOf>
+class NodeIndex<Key, Iterator, KeyOf, HashIndex> {
+  struct Slot {
+    std::size_t hash;
+    NodeBase* node;
+  };
+
+  std::vector<Slot> slots;
+  std::size_t count = 0;
+  unsigned shift = 64;
+
+  static const Key& key(NodeBase* x) {
+    return KeyOf()(*Iterator(x));
+  }
+
+  std::size_t mask() const {
+    return slots.size() - 1;
+  }
+
+  std::size_t home(std::size_t hash) const {
+    return (hash * 0x9e3779b97f4a7c15) >> shift;
+  }
+
+  std::size_t probe(std::size_t hash, const Key& k) const {
+    std::size_t i = home(hash);
+    while (slots[i].node &&
+           (slots[i].hash != hash || !(key(slots[i].node) == k)))
+      i = (i + 1) & mask();
+    return i;
+  }
+
+  void rehash(std::size_t capacity) {
+    std::vector<Slot> old(capacity, Slot{0, nullptr});
+    old.swap(slots);
+    shift = 64 - std::countr_zero(capacity);
+    for (const Slot& s : old)
+      if (s.node) {
+        std::size_t i = home(s.hash);
+        while (slots[i].node)
+          i = (i + 1) & mask();
+        slots[i] = s;
+      }
+  }
+
+public:
+  static constexpr bool enabled = true;
+
+  NodeIndex() = default;
+  NodeIndex(const NodeIndex&) = default;
+  NodeIndex(NodeIndex&& other) :
+      slots(std::move(other.slots)), count(other.count), shift(other.shift) {
+    other.clear();
+  }
+  NodeIndex& operator=(const NodeIndex&) = default;
+  NodeIndex& operator=(NodeIndex&& other) {
+    if (this != &other) {
+      slots = std::move(other.slots);
+      count = other.count;
+      shift = other.shift;
+      other.clear();
+    }
+    return *this;
+  }
+
+  void insert(Iterator it) {
+    if (2 * (count + 1) > slots.size())
+      rehash(std::max<std::size_t>(16, 2 * slots.size()));
+    const std::size_t hash = std::hash<Key>()(key(it.node));
+    const std::size_t i = probe(hash, key(it.node));
+    if (!slots[i].node) {
+      slots[i] = {hash, it.node};
+      ++count;
+    }
+  }
+
+  void erase(Iterator it) {
+    std::size_t i = probe(std::hash<Key>()(key(it.node)), key(it.node));
+    for (std::size_t j = (i + 1) & mask(); slots[j].node; j = (j + 1) & mask())
+      if (((j - home(slots[j].hash)) & mask()) >= ((j - i) & mask())) {
+        slots[i] = slots[j];
+        i = j;
+      }
+    slots[i].node = nullptr;
+    --count;
+  }
+
+  NodeBase* find(const Key& k) const {
+    if (!count)
+      return nullptr;
+    return slots[probe(std::hash<Key>()(k), k)].node;
+  }
+
+  void clear() {
+    slots.clear();
+    count = 0;
+    shift = 64;
+  }
+
+  void assign(Iterator first, Iterator last, std::size_t n) {
+    clear();
+    rehash(std::bit_ceil(std::max<std::size_t>(16, 2 * n)));
+    for (; first != last; ++first)
+      insert(first);
+  }
+
+  std::size_t size() const {
+    return count;
+  }
+
+  std::size_t memory() const {
+    return slots.size() * sizeof(Slot);
+  }
+};
+
+template <class Compare>
+concept Transparent = requires { typename Compare::is_transparent; };
+
+template <class Compare, class Key>
+concept ThreeWayComparator =
+    requires(const Compare& comp, const Key& k) {
+      { comp.compare(k, k) } -> std::convertible_to<std::weak_ordering>;
+    } || ((std::is_same_v<Compare, std::less<Key>> ||
+           std::is_same_v<Compare, std::less<>>) &&
+          std::three_way_comparable<Key, std::weak_ordering>);
+
+template <class Key, class Val, class Hasher, class Compare, bool UniqueKeys,
+          class Augment = NoAugment, class Balance = RedBlack,
+          std::size_t InlineCapacity = 0>
 class RbTree {
   using NodeBase = ::NodeBase;
-  using Node = ::Node<Val>;
-  using Header = ::Header<Val>;
+  using KeyCache = KeyCacheFor<Key, Compare>;
+  using Node = ::Node<Val, Augment, KeyCache>;
+  using Header = ::Header<Node, Balance>;
 
   Header header;
   Compare key_compare;
+  [[no_unique_address]] InlineNodes<Node, InlineCapacity> inline_nodes;
 
   NodeBase* begin_root() const {
     return header.root();
@@ -459,14 +1236,251 @@ class RbTree {
     return Hasher()(Node::up_cast(node)->val);
   }
 
+  static constexpr bool three_way = ThreeWayComparator<Compare, Key>;
+
+  template <class K>
+  std::weak_ordering compare3(const NodeBase* x, const KeyCache& kc,
+                              const K& k) const {
+    if constexpr (Node::cached)
+      if (Node::up_cast(x)->cache != kc)
+        return Node::up_cast(x)->cache <=> kc;
+    if constexpr (requires { key_compare.compare(key(x), k); })
+      return key_compare.compare(key(x), k);
+    else
+      return key(x) <=> k;
+  }
+
+  template <class K>
+  bool node_less(const NodeBase* x, const KeyCache& kc, const K& k) const {
+    if constexpr (Node::cached)
+      if (Node::up_cast(x)->cache != kc)
+        return Node::up_cast(x)->cache < kc;
+    return key_compare(key(x), k);
+  }
+
+  template <class K>
+  bool less_node(const KeyCache& kc, const K& k, const NodeBase* x) const {
+    if constexpr (Node::cached)
+      if (Node::up_cast(x)->cache != kc)
+        return kc < Node::up_cast(x)->cache;
+    return key_compare(k, key(x));
+  }
+
+  template <class Arg>
+  static Node* create_node(Arg&& v) {
+    Node* z = new Node(std::forward<Arg>(v));
+    if constexpr (Node::cached)
+      z->cache = KeyCache(Hasher()(z->val));
+    return z;
+  }
+
+  template <class Arg>
+  static Node* recycle(Node* z, Arg&& v) {
+    if (!z)
+      return create_node(std::forward<Arg>(v));
+    if constexpr (std::is_assignable_v<Val&, Arg>)
+      z->val = std::forward<Arg>(v);
+    else {
+      z->val.~Val();
+      new (&z->val) Val(std::forward<Arg>(v));
+    }
+    if constexpr (Node::cached)
+      z->cache = KeyCache(Hasher()(z->val));
+    return z;
+  }
+
+  struct NodeAllocator {
+    template <class Arg>
+    Node* operator()(Arg&& v) const {
+      return create_node(std::forward<Arg>(v));
+    }
+  };
+
+  class NodeRecycler {
+    NodeBase* root;
+    NodeBase* nodes;
+
+    NodeBase* extract() {
+      if (!nodes)
+        return nullptr;
+      NodeBase* const x = nodes;
+      nodes = nodes->parent;
+      if (!nodes)
+        root = nullptr;
+      else if (nodes->right == x) {
+        nodes->right = nullptr;
+        if (nodes->left) {
+          nodes = nodes->left;
+          while (nodes->right)
+            nodes = nodes->right;
+          if (nodes->left)
+            nodes = nodes->left;
+        }
+      } else
+        nodes->left = nullptr;
+      return x;
+    }
+
+  public:
+    explicit NodeRecycler(Header& header) :
+        nodes(header.rightmost()) {
+      root = header.release();
+      if (!root)
+        nodes = nullptr;
+      else {
+        root->parent = nullptr;
+        if (nodes->left)
+          nodes = nodes->left;
+      }
+    }
+
+    NodeRecycler(const NodeRecycler&) = delete;
+
+    ~NodeRecycler() {
+      Node::deep_erase(Node::up_cast(root));
+    }
+
+    template <class Arg>
+    Node* operator()(Arg&& v) {
+      return recycle(Node::up_cast(extract()), std::forward<Arg>(v));
+    }
+  };
+
 public:
-  using iterator = ::iterator<false, Val>;
-  using const_iterator = ::iterator<true, Val>;
+  using Summary = Node::Summary;
+  using iterator = ::iterator<false, Node>;
+  using const_iterator = ::iterator<true, Node>;
   template <class Self>
   using cc_iterator =
       std::conditional_t<std::is_const_v<Self>, const_iterator, iterator>;
 
 private:
+  using InsertResult =
+      std::conditional_t<UniqueKeys, std::pair<iterator, bool>, iterator>;
+
+  static constexpr bool has_inline = InlineCapacity > 0;
+  static constexpr std::size_t rebuild_ratio = 8;
+
+  bool small() const {
+    return !inline_nodes.spilled;
+  }
+
+  Node* slot(std::size_t i) const {
+    return const_cast<RbTree*>(this)->inline_nodes.slot(i);
+  }
+
+  std::size_t slot_index(const NodeBase* x) const {
+    return x == end_root() ? size() : Node::up_cast(x) - slot(0);
+  }
+
+  template <class Arg>
+  void emplace_slot(std::size_t i, Arg&& v) {
+    Node* z = new (slot(i)) Node(std::forward<Arg>(v));
+    if constexpr (Node::cached)
+      z->cache = KeyCache(Hasher()(z->val));
+  }
+
+  void move_slot(std::size_t to, std::size_t from) {
+    emplace_slot(to, std::move(slot(from)->val));
+    slot(from)->~Node();
+  }
+
+  void relink_slots(std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      NodeBase* const x = slot(i);
+      x->parent = i ? slot(i - 1) : end_root();
+      x->left = nullptr;
+      x->right = i + 1 < n ? slot(i + 1) : nullptr;
+      x->color = Color::Black;
+      x->rank = std::uint32_t(n - i);
+    }
+    header.node_count = n;
+    if (!n)
+      return header.link_sorted(nullptr, 0);
+    header.root() = header.leftmost() = slot(0);
+    header.rightmost() = slot(n - 1);
+    header.update_path(slot(n - 1));
+  }
+
+  void clear_slots() {
+    for (std::size_t i = 0; i < size(); ++i)
+      slot(i)->~Node();
+    relink_slots(0);
+  }
+
+  void spill() {
+    NodeBase* nodes[InlineCapacity] = {};
+    const std::size_t n = size();
+    for (std::size_t i = 0; i < n; ++i) {
+      nodes[i] = create_node(std::move(slot(i)->val));
+      slot(i)->~Node();
+    }
+    inline_nodes.spilled = true;
+    header.link_sorted(nodes, n);
+  }
+
+  template <class K>
+  std::size_t slot_lower_bound(const K& k) const {
+    std::size_t i = 0;
+    for (std::size_t j = 0, n = size(); j < n; ++j)
+      i += key_compare(key(slot(j)), k);
+    return i;
+  }
+
+  template <class K>
+  std::size_t slot_upper_bound(const K& k) const {
+    std::size_t i = 0;
+    for (std::size_t j = 0, n = size(); j < n; ++j)
+      i += !key_compare(k, key(slot(j)));
+    return i;
+  }
+
+  NodeBase* slot_node(std::size_t i) const {
+    return i < size() ? slot(i) : end_root();
+  }
+
+  template <class Arg>
+  InsertResult insert_slot(Arg&& v) {
+    const Key& k = Hasher()(v);
+    const std::size_t n = size();
+    const std::size_t i =
+        UniqueKeys ? slot_lower_bound(k) : slot_upper_bound(k);
+    if constexpr (UniqueKeys)
+      if (i < n && !key_compare(k, key(slot(i))))
+        return std::pair<iterator, bool>(iterator(slot(i)), false);
+    if (n == InlineCapacity) {
+      Val tmp(std::forward<Arg>(v));
+      spill();
+      return insert(std::move(tmp));
+    }
+
+    if (i == n)
+      emplace_slot(n, std::forward<Arg>(v));
+    else {
+      Val tmp(std::forward<Arg>(v));
+      for (std::size_t j = n; j > i; --j)
+        move_slot(j, j - 1);
+      emplace_slot(i, std::move(tmp));
+    }
+    relink_slots(n + 1);
+    if constexpr (UniqueKeys)
+      return std::pair<iterator, bool>(iterator(slot(i)), true);
+    else
+      return iterator(slot(i));
+  }
+
+  iterator erase_slots(std::size_t first, std::size_t last) {
+    const std::size_t n = size();
+    if (first == last)
+      return iterator(slot_node(first));
+    for (std::size_t i = first; i < last; ++i)
+      slot(i)->~Node();
+    for (std::size_t i = last; i < n; ++i)
+      move_slot(first + i - last, i);
+    relink_slots(n - (last - first));
+    return iterator(slot_node(first));
+  }
+
   std::pair<NodeBase*, NodeBase*> get_insert_pos(const Key& k) {
     NodeBase* x = begin_root();
     NodeBase* y = end_root();
@@ -565,32 +1579,239 @@ private:
     return insert_lower_node(y, z);
   }
 
-  NodeBase* lower_bound_base(NodeBase* x, NodeBase* y, const Key& k) const {
+  template <class K>
+  NodeBase* lower_bound_base(NodeBase* x, NodeBase* y, const K& k) const {
+    const KeyCache kc(k);
     while (x)
-      if (!key_compare(key(x), k))
+      if (!node_less(x, kc, k))
         y = x, x = x->left;
       else
         x = x->right;
     return y;
   }
 
-  NodeBase* upper_bound_base(NodeBase* x, NodeBase* y, const Key& k) const {
+  template <class K>
+  NodeBase* upper_bound_base(NodeBase* x, NodeBase* y, const K& k) const {
+    const KeyCache kc(k);
     while (x)
-      if (key_compare(k, key(x)))
+      if (less_node(kc, k, x))
         y = x, x = x->left;
       else
         x = x->right;
     return y;
   }
 
+  template <class Right>
+  std::pair<NodeBase*, NodeBase*> finger(NodeBase* x, Right right) const {
+    if (x == end_root())
+      x = header.rightmost();
+    const bool forward = right(x);
+    while (x != begin_root()) {
+      NodeBase* const p = x->parent;
+      if (forward ? x == p->left && !right(p) : x == p->right && right(p))
+        return {x, forward ? p : end_root()};
+      x = p;
+    }
+    return {x, end_root()};
+  }
+
+  static Summary lift(const NodeBase* x) {
+    return Augment::lift(Node::up_cast(x)->val);
+  }
+
+  static Summary fold_from(const NodeBase* x, const NodeBase* stop) {
+    Summary acc = Augment::combine(lift(x), Node::summary_of(x->right));
+    for (const NodeBase *c = x, *a = x->parent; a != stop; c = a, a = a->parent)
+      if (c == a->left)
+        acc = Augment::combine(Augment::combine(acc, lift(a)),
+                               Node::summary_of(a->right));
+    return acc;
+  }
+
+  static Summary fold_before(const NodeBase* x, const NodeBase* stop) {
+    Summary acc = Node::summary_of(x->left);
+    for (const NodeBase *c = x, *a = x->parent; a != stop; c = a, a = a->parent)
+      if (c == a->right)
+        acc = Augment::combine(
+            Augment::combine(Node::summary_of(a->left), lift(a)), acc);
+    return acc;
+  }
+
+  template <class SummaryPred, class Pred, class Stop>
+  static NodeBase* first_match(NodeBase* x, SummaryPred& sp, Pred& pred,
+                               Stop& stop) {
+    while (x)
+      if (x->left && sp(Node::summary_of(x->left)))
+        x = x->left;
+      else if (stop(Node::up_cast(x)->val))
+        return nullptr;
+      else if (pred(Node::up_cast(x)->val))
+        return x;
+      else if (x->right && sp(Node::summary_of(x->right)))
+        x = x->right;
+      else
+        return nullptr;
+    return nullptr;
+  }
+
+  std::size_t depth(const NodeBase* x) const {
+    std::size_t d = 0;
+    for (; x != end_root(); x = x->parent)
+      ++d;
+    return d;
+  }
+
+  bool precedes(const NodeBase* a, const NodeBase* b) const {
+    if (a == b || a == end_root())
+      return false;
+    if (b == end_root())
+      return true;
+    const NodeBase* ca = nullptr;
+    const NodeBase* cb = nullptr;
+    std::size_t da = depth(a);
+    std::size_t db = depth(b);
+    for (; da > db; --da)
+      ca = a, a = a->parent;
+    for (; db > da; --db)
+      cb = b, b = b->parent;
+    while (a != b)
+      ca = a, a = a->parent, cb = b, b = b->parent;
+    return ca ? ca == a->left : cb == a->right;
+  }
+
+  void collect_cuts(NodeBase* x, std::size_t depth, std::size_t limit,
+                    const NodeBase* first, const NodeBase* last,
+                    std::vector<NodeBase*>& cuts, bool& deeper) const {
+    if (!x)
+      return;
+    if (depth == limit) {
+      deeper = true;
+      return;
+    }
+    const bool after_first = precedes(first, x);
+    const bool before_last = precedes(x, last);
+    if (after_first)
+      collect_cuts(x->left, depth + 1, limit, first, last, cuts, deeper);
+    if (after_first && before_last)
+      cuts.push_back(x);
+    if (before_last)
+      collect_cuts(x->right, depth + 1, limit, first, last, cuts, deeper);
+  }
+
+  std::vector<NodeBase*> split_nodes(NodeBase* first, NodeBase* last,
+                                     std::size_t n) const {
+    if (first == last)
+      return {first};
+    std::vector<NodeBase*> cuts;
+    for (std::size_t limit = 1;; ++limit) {
+      bool deeper = false;
+      cuts.clear();
+      collect_cuts(begin_root(), 0, limit, first, last, cuts, deeper);
+      if (cuts.size() + 1 >= n || !deeper)
+        break;
+    }
+
+    std::vector<NodeBase*> bounds{first};
+    const std::size_t m = cuts.size();
+    if (m + 1 <= n)
+      bounds.insert(bounds.end(), cuts.begin(), cuts.end());
+    else
+      for (std::size_t i = 1; i < n; ++i)
+        bounds.push_back(cuts[i * m / n]);
+    bounds.push_back(last);
+    return bounds;
+  }
+
+  template <class F>
+  void diff_base(const NodeBase* x, const Key* lo, const Key* hi,
+                 const RbTree& other, F& f) const {
+    const_iterator first = lo ? other.upper_bound(*lo) : other.begin();
+    const_iterator last = hi ? other.lower_bound(*hi) : other.end();
+    if (!x) {
+      for (; first != last; ++first)
+        f(key(first.node));
+      return;
+    }
+    if (Node::up_cast(x)->summary == other.aggregate(first, last))
+      return;
+
+    diff_base(x->left, lo, &key(x), other, f);
+    const_iterator it = other.find(key(x));
+    if (it == other.end() || !(*it == Node::up_cast(x)->val))
+      f(key(x));
+    diff_base(x->right, &key(x), hi, other, f);
+  }
+
+  template <class Arg, class Gen>
+  iterator insert_hint_with(const_iterator position, Arg&& v, Gen&& gen) {
+    auto res = get_insert_hint_pos(position, Hasher()(v));
+    if (res.second)
+      return insert_node(res.first, res.second, gen(std::forward<Arg>(v)));
+
+    if constexpr (UniqueKeys)
+      return iterator(res.first);
+    else
+      return insert_equal_lower_node(gen(std::forward<Arg>(v)));
+  }
+
 public:
   RbTree() = default;
   RbTree(const Compare& comp) : key_compare(comp) {}
-  RbTree(const RbTree& x) = default;
-  RbTree(RbTree&& x) = default;
-  RbTree& operator=(const RbTree& x) = default;
-  RbTree& operator=(RbTree&& x) = default;
-  ~RbTree() = default;
+  RbTree(const RbTree& x) :
+      header(x.small() ? Header() : x.header), key_compare(x.key_compare) {
+    if constexpr (has_inline) {
+      if (x.small()) {
+        for (std::size_t i = 0; i < x.size(); ++i)
+          emplace_slot(i, x.slot(i)->val);
+        relink_slots(x.size());
+      } else
+        inline_nodes.spilled = true;
+    }
+  }
+
+  RbTree(RbTree&& x) :
+      header(x.small() ? Header() : std::move(x.header)),
+      key_compare(std::move(x.key_compare)) {
+    if constexpr (has_inline) {
+      if (x.small()) {
+        for (std::size_t i = 0; i < x.size(); ++i)
+          emplace_slot(i, std::move(x.slot(i)->val));
+        relink_slots(x.size());
+        x.clear_slots();
+      } else {
+        inline_nodes.spilled = true;
+        x.inline_nodes.spilled = false;
+      }
+    }
+  }
+
+  RbTree& operator=(const RbTree& x) {
+    if (this == &x)
+      return *this;
+    if (small() || x.small()) {
+      RbTree copy(x);
+      swap(copy);
+      return *this;
+    }
+    key_compare = x.key_compare;
+    NodeRecycler recycler(header);
+    header.copy(x.header, recycler);
+    return *this;
+  }
+
+  RbTree& operator=(RbTree&& x) {
+    if (this != &x) {
+      this->~RbTree();
+      new (this) RbTree(std::move(x));
+    }
+    return *this;
+  }
+
+  ~RbTree() {
+    if constexpr (has_inline)
+      if (small())
+        clear_slots();
+  }
 
   Compare key_comp() const {
     return key_compare;
@@ -608,38 +1829,226 @@ public:
     return header.node_count;
   }
 
+  // Checks the links, the balance, the key order and the cached key
+  // prefixes of the whole tree.
+  bool verify() const {
+    if (!header.verify(!small()))
+      return false;
+    for (const_iterator it = begin(); it != end(); ++it) {
+      if constexpr (Node::cached)
+        if (Node::up_cast(it.node)->cache != KeyCache(key(it.node)))
+          return false;
+      if (it.node == header.leftmost())
+        continue;
+      const NodeBase* const prev = std::prev(it).node;
+      if (UniqueKeys ? !key_compare(key(prev), key(it.node))
+                     : key_compare(key(it.node), key(prev)))
+        return false;
+    }
+    return true;
+  }
+
   void swap(RbTree& t) {
     std::swap(*this, t);
   }
 
   template <class Arg>
-  auto insert(Arg&& v) {
+  InsertResult insert(Arg&& v) {
+    if constexpr (has_inline)
+      if (small())
+        return insert_slot(std::forward<Arg>(v));
+    return insert_with(std::forward<Arg>(v), NodeAllocator());
+  }
+
+  template <class Arg, class Gen>
+  InsertResult insert_with(Arg&& v, Gen&& gen)
+  requires three_way
+  {
+    const Key& k = Hasher()(v);
+    const KeyCache kc(k);
+    NodeBase* x = begin_root();
+    NodeBase* y = end_root();
+    bool insert_left = true;
+    while (x) {
+      const auto c = compare3(x, kc, k);
+      if constexpr (UniqueKeys)
+        if (c == 0)
+          return std::pair<iterator, bool>(iterator(x), false);
+      y = x;
+      insert_left = c > 0;
+      x = insert_left ? x->left : x->right;
+    }
+
+    Node* z = gen(std::forward<Arg>(v));
+    header.insert(insert_left, z, y);
+    if constexpr (UniqueKeys)
+      return std::pair<iterator, bool>(iterator(z), true);
+    else
+      return iterator(z);
+  }
+
+  template <class Arg, class Gen>
+  InsertResult insert_with(Arg&& v, Gen&& gen) {
     auto res = get_insert_pos(Hasher()(v));
 
     if constexpr (UniqueKeys) {
       using Res = std::pair<iterator, bool>;
       if (res.second)
         return Res(
-            insert_node(res.first, res.second, new Node(std::forward<Arg>(v))),
+            insert_node(res.first, res.second, gen(std::forward<Arg>(v))),
             true);
       return Res(iterator(res.first), false);
     } else
-      return insert_node(res.first, res.second, new Node(std::forward<Arg>(v)));
+      return insert_node(res.first, res.second, gen(std::forward<Arg>(v)));
   }
 
   template <class Arg>
   iterator insert_hint(const_iterator position, Arg&& v) {
-    auto res = get_insert_hint_pos(position, Hasher()(v));
-    if (res.second)
-      return insert_node(res.first, res.second, new Node(std::forward<Arg>(v)));
+    if constexpr (has_inline)
+      if (small()) {
+        if constexpr (UniqueKeys)
+          return insert_slot(std::forward<Arg>(v)).first;
+        else
+          return insert_slot(std::forward<Arg>(v));
+      }
+    return insert_hint_with(position, std::forward<Arg>(v), NodeAllocator());
+  }
 
+  template <class Arg>
+  InsertResult push_back(Arg&& v) {
+    if constexpr (has_inline)
+      if (small())
+        return insert_slot(std::forward<Arg>(v));
+    NodeBase* const p = header.rightmost();
+    if (size() && !cmp(key(p), Hasher()(v)))
+      return insert(std::forward<Arg>(v));
+    Node* const z = create_node(std::forward<Arg>(v));
+    header.insert(!size(), z, p);
     if constexpr (UniqueKeys)
-      return iterator(res.first);
+      return std::pair<iterator, bool>(iterator(z), true);
     else
-      return insert_equal_lower_node(new Node(std::forward<Arg>(v)));
+      return iterator(z);
+  }
+
+  using node_pointer = Node*;
+
+  template <class Arg>
+  static node_pointer make_node(node_pointer spare, Arg&& v) {
+    return recycle(spare, std::forward<Arg>(v));
+  }
+
+  static void drop_node(node_pointer z) {
+    Node::destroy(z);
+  }
+
+  std::vector<node_pointer> release_nodes()
+  requires(!has_inline)
+  {
+    std::vector<node_pointer> nodes;
+    nodes.reserve(size());
+    for (iterator it = begin(); it != end(); ++it)
+      nodes.push_back(Node::up_cast(it.node));
+    header.release();
+    return nodes;
+  }
+
+  void link_nodes(const std::vector<node_pointer>& nodes)
+  requires(!has_inline)
+  {
+    clear();
+    header.link_sorted(reinterpret_cast<NodeBase* const*>(nodes.data()),
+                       nodes.size());
+  }
+
+  template <std::random_access_iterator RandomIt>
+  void build(Parallel policy, RandomIt first, RandomIt last) {
+    const std::size_t n = last - first;
+    if (!n)
+      return;
+    constexpr std::size_t grain = 1 << 14;
+    const std::size_t threads =
+        std::clamp<std::size_t>(policy.threads, 1, (n + grain - 1) / grain);
+    std::vector<NodeBase*> nodes(n);
+    std::vector<std::size_t> bounds(threads + 1);
+    for (std::size_t i = 0; i <= threads; ++i)
+      bounds[i] = n * i / threads;
+
+    const auto less = [this](const NodeBase* a, const NodeBase* b) {
+      return key_compare(key(a), key(b));
+    };
+    // nodes holds every node built so far. Sorting and merging write into
+    // scratch and then swap, so a throwing constructor or comparator leaves
+    // nodes complete and they can all be freed.
+    std::vector<NodeBase*> scratch(n);
+    try {
+      run_parallel(threads, [&](std::size_t t) {
+        for (std::size_t i = bounds[t]; i < bounds[t + 1]; ++i)
+          nodes[i] = create_node(first[i]);
+        std::copy(nodes.begin() + bounds[t], nodes.begin() + bounds[t + 1],
+                  scratch.begin() + bounds[t]);
+        std::stable_sort(scratch.begin() + bounds[t],
+                         scratch.begin() + bounds[t + 1], less);
+      });
+      nodes.swap(scratch);
+      while (bounds.size() > 2) {
+        const std::size_t merges = (bounds.size() - 1) / 2;
+        run_parallel(merges, [&](std::size_t m) {
+          std::merge(nodes.begin() + bounds[2 * m],
+                     nodes.begin() + bounds[2 * m + 1],
+                     nodes.begin() + bounds[2 * m + 1],
+                     nodes.begin() + bounds[2 * m + 2],
+                     scratch.begin() + bounds[2 * m], less);
+        });
+        std::copy(nodes.begin() + bounds[2 * merges], nodes.end(),
+                  scratch.begin() + bounds[2 * merges]);
+        nodes.swap(scratch);
+        for (std::size_t i = 1; 2 * i < bounds.size(); ++i)
+          bounds[i] = bounds[2 * i];
+        bounds.resize(bounds.size() / 2 + 1);
+        bounds.back() = n;
+      }
+    } catch (...) {
+      for (NodeBase* x : nodes)
+        if (x)
+          Node::destroy(Node::up_cast(x));
+      throw;
+    }
+
+    std::size_t size = n;
+    if constexpr (UniqueKeys) {
+      size = 1;
+      for (std::size_t i = 1; i < n; ++i)
+        if (less(nodes[size - 1], nodes[i]))
+          nodes[size++] = nodes[i];
+        else
+          Node::destroy(Node::up_cast(nodes[i]));
+    }
+    clear();
+    if constexpr (has_inline)
+      inline_nodes.spilled = true;
+    header.link_sorted(nodes.data(), size, threads);
+  }
+
+  template <class InputIterator>
+  void assign(InputIterator first, InputIterator last) {
+    if constexpr (has_inline)
+      if (small()) {
+        clear();
+        while (first != last)
+          insert(*first++);
+        return;
+      }
+    NodeRecycler recycler(header);
+    while (first != last)
+      insert_hint_with(end(), *first++, recycler);
   }
 
   iterator erase(iterator position) {
+    if constexpr (has_inline)
+      if (small()) {
+        const std::size_t i = slot_index(position.node);
+        return erase_slots(i, i + 1);
+      }
     header.erase((position++).node);
     return position;
   }
@@ -648,41 +2057,270 @@ public:
     return erase(iterator(position.node));
   }
 
+  iterator erase(const_iterator first, const_iterator last) {
+    if constexpr (has_inline)
+      if (small())
+        return erase_slots(slot_index(first.node), slot_index(last.node));
+    if (first == begin() && last == end())
+      clear();
+    else if constexpr (!std::is_same_v<Balance, RedBlack>) {
+      while (first != last)
+        header.erase((first++).node);
+    } else if (first != last && std::next(first) == last)
+      header.erase(first.node);
+    else if (first != last)
+      header.erase(first.node, last.node);
+    return iterator(last.node);
+  }
+
+  std::size_t erase(const Key& k) {
+    auto p = equal_range(k);
+    const std::size_t old_size = size();
+    erase(p.first, p.second);
+    return old_size - size();
+  }
+
+  template <class Pred>
+  std::size_t erase_if(Pred pred) {
+    return erase_if(pred, [](iterator) {});
+  }
+
+  // Calls drop on each match once pred has seen every element and before
+  // any match is unlinked, so a throwing pred leaves both untouched. Fewer
+  // than size() / ratio matches are erased one by one, more are dropped by
+  // relinking the survivors.
+  template <class Pred, class Drop>
+  std::size_t erase_if(Pred pred, Drop drop,
+                       std::size_t ratio = rebuild_ratio) {
+    const std::size_t old_size = size();
+    if constexpr (has_inline)
+      if (small()) {
+        for (iterator i = begin(); i != end();)
+          if (pred(i)) {
+            drop(i);
+            i = erase(i);
+          } else
+            ++i;
+        return old_size - size();
+      }
+    std::vector<NodeBase*> nodes(old_size), path;
+    std::size_t kept = 0, dropped = old_size;
+    for (NodeBase* x = header.root(); x || !path.empty();) {
+      for (; x; x = x->left)
+        path.push_back(x);
+      NodeBase* const y = path.back();
+      path.pop_back();
+      x = y->right;
+      nodes[pred(iterator(y)) ? --dropped : kept++] = y;
+    }
+    for (std::size_t i = dropped; i < old_size; ++i)
+      drop(iterator(nodes[i]));
+    if ((old_size - dropped) * ratio < old_size)
+      for (std::size_t i = old_size; i-- > dropped;)
+        header.erase(nodes[i]);
+    else {
+      header.release();
+      header.link_sorted(nodes.data(), kept);
+      for (std::size_t i = dropped; i < old_size; ++i)
+        Node::destroy(Node::up_cast(nodes[i]));
+    }
+    return old_size - kept;
+  }
+
   void clear() {
+    if constexpr (has_inline) {
+      if (small())
+        return clear_slots();
+      inline_nodes.spilled = false;
+    }
     header.clear();
   }
 
-  auto find(this auto&& self, const Key& k) {
-    cc_iterator<decltype(self)> j(
-        self.lower_bound_base(self.begin_root(), self.end_root(), k));
-    return self.key_compare(k, key(j.node)) ? self.end() : j;
+  void update(const_iterator position) {
+    header.update_path(position.node);
+  }
+
+  void compact() {
+    if constexpr (has_inline)
+      if (small())
+        return;
+    constexpr std::size_t offset =
+        (sizeof(NodeChunk) + alignof(Node) - 1) / alignof(Node) * alignof(Node);
+    constexpr std::size_t per_chunk =
+        (NodeChunk::bytes - offset) / sizeof(Node);
+    if (per_chunk < 16 || !size())
+      return;
+
+    std::vector<NodeBase*> old;
+    old.reserve(size());
+    NodeChunk* chunk = nullptr;
+    std::size_t used = per_chunk;
+    for (iterator it = begin(); it != end(); ++it) {
+      Node* const x = Node::up_cast(it.node);
+      if (used == per_chunk)
+        chunk = NodeChunk::allocate(), used = 0;
+      void* const p =
+          reinterpret_cast<std::byte*>(chunk) + offset + used++ * sizeof(Node);
+      Node* const y = new (p) Node(std::move(x->val));
+      ++chunk->live;
+      y->pooled = true;
+      y->color = x->color;
+      y->rank = x->rank;
+      y->parent = x->parent;
+      y->left = x->left;
+      y->right = x->right;
+      y->cache = x->cache;
+      y->summary = x->summary;
+      old.push_back(x);
+      x->left = y;
+    }
+
+    const auto moved = [this](NodeBase* x) {
+      return x && x != end_root() ? x->left : x;
+    };
+    for (NodeBase* x : old) {
+      NodeBase* const y = x->left;
+      y->parent = moved(y->parent);
+      y->left = moved(y->left);
+      y->right = moved(y->right);
+    }
+    header.root() = moved(header.root());
+    header.leftmost() = moved(header.leftmost());
+    header.rightmost() = moved(header.rightmost());
+    for (NodeBase* x : old)
+      Node::destroy(Node::up_cast(x));
+  }
+
+  template <class K>
+  auto find(this auto&& self, const K& k) {
+    cc_iterator<decltype(self)> j = self.end();
+    if constexpr (has_inline)
+      if (self.small()) {
+        const std::size_t i = self.slot_lower_bound(k);
+        if (i < self.size() && !self.key_compare(k, key(self.slot(i))))
+          j.node = self.slot(i);
+        return j;
+      }
+    if constexpr (three_way) {
+      const KeyCache kc(k);
+      NodeBase* x = self.begin_root();
+      bool found = false;
+      while (x) {
+        const auto c = self.compare3(x, kc, k);
+        if (c < 0)
+          x = x->right;
+        else {
+          j.node = x;
+          found = c == 0;
+          if (UniqueKeys && found)
+            break;
+          x = x->left;
+        }
+      }
+      if (!found)
+        return self.end();
+    } else {
+      j.node = self.lower_bound_base(self.begin_root(), self.end_root(), k);
+      if (j == self.end() || self.key_compare(k, key(j.node)))
+        return self.end();
+    }
+    if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)>>)
+      self.header.access(j.node);
+    return j;
   }
 
-  std::size_t count(const Key& k) const {
+  template <class K>
+  std::size_t count(const K& k) const {
     std::pair<const_iterator, const_iterator> p = equal_range(k);
     return std::distance(p.first, p.second);
   }
 
-  auto lower_bound(this auto&& self, const Key& k) {
-    return cc_iterator<decltype(self)>(
+  template <class K>
+  auto lower_bound(this auto&& self, const K& k) {
+    if constexpr (has_inline)
+      if (self.small())
+        return cc_iterator<decltype(self)>(
+            self.slot_node(self.slot_lower_bound(k)));
+    cc_iterator<decltype(self)> j(
         self.lower_bound_base(self.begin_root(), self.end_root(), k));
+    if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)>>)
+      self.header.access(j.node);
+    return j;
   }
 
-  auto upper_bound(this auto&& self, const Key& k) {
+  template <class K>
+  auto upper_bound(this auto&& self, const K& k) {
+    if constexpr (has_inline)
+      if (self.small())
+        return cc_iterator<decltype(self)>(
+            self.slot_node(self.slot_upper_bound(k)));
     return cc_iterator<decltype(self)>(
         self.upper_bound_base(self.begin_root(), self.end_root(), k));
   }
 
-  auto equal_range(this auto&& self, const Key& k) {
+  template <class K>
+  auto lower_bound_from(this auto&& self, const_iterator position,
+                        const K& k) {
+    if constexpr (has_inline)
+      if (self.small())
+        return self.lower_bound(k);
+    if (!self.size())
+      return self.end();
+    const KeyCache kc(k);
+    const auto [x, y] = self.finger(position.node, [&](const NodeBase* n) {
+      return self.node_less(n, kc, k);
+    });
+    cc_iterator<decltype(self)> j(self.lower_bound_base(x, y, k));
+    if constexpr (!std::is_const_v<std::remove_reference_t<decltype(self)>>)
+      self.header.access(j.node);
+    return j;
+  }
+
+  template <class K>
+  auto upper_bound_from(this auto&& self, const_iterator position,
+                        const K& k) {
+    if constexpr (has_inline)
+      if (self.small())
+        return self.upper_bound(k);
+    if (!self.size())
+      return self.end();
+    const KeyCache kc(k);
+    const auto [x, y] = self.finger(position.node, [&](const NodeBase* n) {
+      return !self.less_node(kc, k, n);
+    });
+    return cc_iterator<decltype(self)>(self.upper_bound_base(x, y, k));
+  }
+
+  template <class K>
+  auto find_from(this auto&& self, const_iterator position, const K& k) {
+    auto j = self.lower_bound_from(position, k);
+    if (j == self.end() || self.key_compare(k, key(j.node)))
+      return self.end();
+    return j;
+  }
+
+  template <class K>
+  auto equal_range(this auto&& self, const K& k) {
     using cc_iterator = cc_iterator<decltype(self)>;
     using Ret = std::pair<cc_iterator, cc_iterator>;
+    if constexpr (has_inline)
+      if (self.small())
+        return Ret(cc_iterator(self.slot_node(self.slot_lower_bound(k))),
+                   cc_iterator(self.slot_node(self.slot_upper_bound(k))));
 
+    const KeyCache kc(k);
     NodeBase* x = self.begin_root();
     NodeBase* y = self.end_root();
     while (x) {
-      if (self.key_compare(key(x), k))
+      int c;
+      if constexpr (three_way) {
+        const auto order = self.compare3(x, kc, k);
+        c = order < 0 ? -1 : order > 0;
+      } else
+        c = self.key_compare(key(x), k) ? -1 : self.key_compare(k, key(x));
+      if (c < 0)
         x = x->right;
-      else if (self.key_compare(k, key(x)))
+      else if (c > 0)
         y = x, x = x->left;
       else {
         NodeBase* xu(x);
@@ -696,7 +2334,130 @@ public:
     return Ret(cc_iterator(y), cc_iterator(y));
   }
 
+  Summary aggregate() const {
+    return Node::summary_of(begin_root());
+  }
+
+  Summary aggregate(const_iterator first, const_iterator last) const {
+    if (first == last)
+      return Augment::identity();
+    if (last == end())
+      return fold_from(first.node, end_root());
+
+    const NodeBase* a = first.node;
+    const NodeBase* b = last.node;
+    std::size_t da = depth(a);
+    std::size_t db = depth(b);
+    for (; da > db; --da)
+      a = a->parent;
+    for (; db > da; --db)
+      b = b->parent;
+    while (a != b)
+      a = a->parent, b = b->parent;
+
+    if (a == first.node)
+      return Augment::combine(lift(a), fold_before(last.node, a));
+    if (a == last.node)
+      return fold_from(first.node, a);
+    return Augment::combine(
+        Augment::combine(fold_from(first.node, a), lift(a)),
+        fold_before(last.node, a));
+  }
+
+  template <class Pred>
+  auto prefix_search(this auto&& self, Pred pred) {
+    Summary acc = Augment::identity();
+    NodeBase* x = self.begin_root();
+    while (x) {
+      const Summary left = Augment::combine(acc, Node::summary_of(x->left));
+      if (pred(left)) {
+        x = x->left;
+        continue;
+      }
+      acc = Augment::combine(left, lift(x));
+      if (pred(acc))
+        return cc_iterator<decltype(self)>(x);
+      x = x->right;
+    }
+    return self.end();
+  }
+
+  // The first element in order that satisfies pred, skipping subtrees whose
+  // summary fails sp. stop must be monotone in key order; the search gives
+  // up at the first element it holds for.
+  template <class SummaryPred, class Pred, class Stop>
+  auto find_first(this auto&& self, SummaryPred sp, Pred pred, Stop stop) {
+    NodeBase* x = self.begin_root();
+    if (x && sp(Node::summary_of(x)))
+      if (NodeBase* y = first_match(x, sp, pred, stop))
+        return cc_iterator<decltype(self)>(y);
+    return self.end();
+  }
+
+  // Continues the in-order walk of find_first from position. Every edge is
+  // followed at most once down and once up over a whole enumeration.
+  template <class SummaryPred, class Pred, class Stop>
+  auto find_next(this auto&& self, const_iterator position, SummaryPred sp,
+                 Pred pred, Stop stop) {
+    using cc_iterator = cc_iterator<decltype(self)>;
+    NodeBase* x = position.node;
+    NodeBase* y = nullptr;
+    if (x->right && sp(Node::summary_of(x->right)))
+      y = first_match(x->right, sp, pred, stop);
+    else
+      for (NodeBase *c = x, *a = x->parent; a != self.end_root();
+           c = a, a = a->parent) {
+        if (c != a->left)
+          continue;
+        if (stop(Node::up_cast(a)->val))
+          break;
+        if (pred(Node::up_cast(a)->val)) {
+          y = a;
+          break;
+        }
+        if (a->right && sp(Node::summary_of(a->right))) {
+          y = first_match(a->right, sp, pred, stop);
+          break;
+        }
+      }
+    return y ? cc_iterator(y) : self.end();
+  }
+
+  std::vector<std::pair<const_iterator, const_iterator>>
+  split_ranges(const_iterator first, const_iterator last,
+               std::size_t n) const {
+    const std::vector<NodeBase*> bounds = split_nodes(first.node, last.node, n);
+    std::vector<std::pair<const_iterator, const_iterator>> ranges;
+    for (std::size_t i = 0; i + 1 < bounds.size(); ++i)
+      ranges.emplace_back(const_iterator(bounds[i]),
+                          const_iterator(bounds[i + 1]));
+    return ranges;
+  }
+
+  template <class It, class F>
+  void parallel_for_each(Parallel policy, It first, It last, F f) const {
+    const std::size_t threads = std::max<std::size_t>(policy.threads, 1);
+    const std::vector<NodeBase*> bounds =
+        split_nodes(first.node, last.node, threads * 8);
+    std::atomic<std::size_t> next = 0;
+    run_parallel(std::min(threads, bounds.size() - 1), [&](std::size_t) {
+      for (std::size_t i; (i = next++) + 1 < bounds.size();)
+        for (It it(bounds[i]); it != It(bounds[i + 1]); ++it)
+          f(*it);
+    });
+  }
+
+  template <class F>
+  void diff(const RbTree& other, F f) const
+  requires UniqueKeys
+  {
+    diff_base(begin_root(), nullptr, nullptr, other, f);
+  }
+
   friend bool operator==(const RbTree& x, const RbTree& y) {
+    if constexpr (std::is_same_v<Augment, MerkleHash>)
+      if (x.aggregate() != y.aggregate())
+        return false;
     return x.size() == y.size() && std::equal(x.begin(), x.end(), y.begin());
   }
 
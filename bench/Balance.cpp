@@ -0,0 +1,63 @@
+#include "Set.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Milliseconds for 1M operations on int keys under each balancing policy.
+// Run it on an optimized build.
+template <class Balance>
+void run(const char* name, const std::vector<int>& keys,
+         const std::vector<int>& skewed) {
+  using Set = BasicSet<int, std::less<int>, true, NoAugment, Balance>;
+  const auto time = [](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  std::size_t sink = 0;
+  Set s;
+  const double insert = time([&] {
+    for (int k : keys)
+      s.insert(k);
+  });
+  const double find = time([&] {
+    for (int k : keys)
+      sink += s.find(k ^ 1) != s.end();
+  });
+  const double skewed_find = time([&] {
+    for (int k : skewed)
+      sink += s.find(k) != s.end();
+  });
+  const double churn = time([&] {
+    for (int k : keys) {
+      s.erase(k);
+      s.insert(k);
+    }
+  });
+  Set ascending;
+  const double sequential = time([&] {
+    for (int i = 0; i < int(keys.size()); ++i)
+      ascending.insert(i);
+  });
+  std::printf("%-8s %8.1f %8.1f %8.1f %8.1f %8.1f   (%zu)\n", name, insert,
+              find, skewed_find, churn, sequential, sink);
+}
+
+int main() {
+  std::mt19937 rng(30);
+  std::vector<int> keys(1'000'000), skewed(1'000'000);
+  for (int& k : keys)
+    k = rng();
+  // 90% of the lookups go to 1000 hot keys.
+  for (int& k : skewed)
+    k = keys[rng() % 10 ? rng() % 1000 : rng() % keys.size()];
+  std::printf("%-8s %8s %8s %8s %8s %8s\n", "policy", "insert", "find",
+              "skewed", "churn", "in order");
+  run<RedBlack>("RedBlack", keys, skewed);
+  run<Avl>("Avl", keys, skewed);
+  run<Treap>("Treap", keys, skewed);
+  run<Splay>("Splay", keys, skewed);
+}
@@ -0,0 +1,47 @@
+#include "Tree.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Milliseconds for erase_if to remove a fraction of 1M ints, forced to
+// erase the matches one by one, forced to relink the survivors, and with
+// the default rebuild_ratio of 8, which rebuilds from 1/8 up. The default
+// should track the faster of the two forced columns. Run it on an
+// optimized build.
+using Tree = RbTree<int, int, std::identity, std::less<int>, false>;
+
+int main() {
+  const auto time = [](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  std::mt19937 rng(47);
+  Tree original;
+  for (int i = 0; i < 1'000'000; ++i)
+    original.insert(int(rng()));
+  const std::size_t n = original.size();
+
+  std::size_t sink = 0;
+  std::printf("%-8s %8s %8s %8s\n", "matches", "erase", "rebuild", "default");
+  for (unsigned denominator : {64, 32, 16, 12, 10, 8, 6, 4, 2, 1}) {
+    // The keys are random, so each element matches independently.
+    const auto pred = [&](Tree::iterator i) {
+      return unsigned(*i) / 7 % denominator == 0;
+    };
+    const auto drop = [](Tree::iterator) {};
+    // A ratio of 0 never rebuilds, and one of n rebuilds on any match.
+    double ms[3];
+    const std::size_t ratios[3] = {0, n, 8};
+    for (int i = 0; i < 3; ++i) {
+      Tree t = original;
+      ms[i] = time([&] { sink += t.erase_if(pred, drop, ratios[i]); });
+    }
+    std::printf("1/%-6u %8.1f %8.1f %8.1f\n", denominator, ms[0], ms[1],
+                ms[2]);
+  }
+  std::printf("(%zu)\n", sink);
+}
@@ -0,0 +1,54 @@
+#include "Set.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Milliseconds to intersect a 1M-element Set with sorted probe lists of
+// growing size: a lower_bound from the root per probe, a lower_bound_from
+// the previous result per probe, and a linear merge of both sequences.
+// Run it on an optimized build.
+int main() {
+  const auto time = [](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  std::mt19937 rng(43);
+  Set<int> set;
+  while (set.size() < 1'000'000)
+    set.insert(rng() % 4'000'000);
+
+  std::size_t sink = 0;
+  std::printf("%-8s %8s %8s %8s\n", "probes", "root", "finger", "merge");
+  for (std::size_t n : {100, 10'000, 100'000, 1'000'000}) {
+    Set<int> probes;
+    while (probes.size() < n)
+      probes.insert(rng() % 4'000'000);
+    const double root = time([&] {
+      for (int k : probes) {
+        const auto it = set.lower_bound(k);
+        sink += it != set.end() && *it == k;
+      }
+    });
+    const double finger = time([&] {
+      auto it = set.begin();
+      for (int k : probes) {
+        it = set.lower_bound_from(it, k);
+        sink += it != set.end() && *it == k;
+      }
+    });
+    const double merge = time([&] {
+      auto it = set.begin();
+      for (int k : probes) {
+        while (it != set.end() && *it < k)
+          ++it;
+        sink += it != set.end() && *it == k;
+      }
+    });
+    std::printf("%-8zu %8.1f %8.1f %8.1f\n", n, root, finger, merge);
+  }
+  std::printf("(%zu)\n", sink);
+}
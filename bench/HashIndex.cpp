@@ -0,0 +1,54 @@
+#include "Map.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Milliseconds for inserts, lookups and erases with and without the hash
+// side-index, for growing sizes, with the index's extra bytes per element.
+// Lookups hit half of the time. Run it on an optimized build.
+template <class Container>
+void run(const char* name, const std::vector<int>& keys,
+         const std::vector<int>& probes) {
+  const auto time = [](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  std::size_t sink = 0;
+  Container m;
+  const double insert = time([&] {
+    for (int k : keys)
+      m.emplace(k, k);
+  });
+  const double find = time([&] {
+    for (int k : probes)
+      sink += m.find(k) != m.end();
+  });
+  double bytes = 0;
+  if constexpr (requires { m.index_memory(); })
+    bytes = double(m.index_memory()) / m.size();
+  const double erase = time([&] {
+    for (int k : keys)
+      sink += m.erase(k);
+  });
+  std::printf("%-8s %9zu %8.1f %8.1f %8.1f %8.1f   (%zu)\n", name,
+              keys.size(), insert, find, erase, bytes, sink);
+}
+
+int main() {
+  std::mt19937 rng(44);
+  std::printf("%-8s %9s %8s %8s %8s %8s\n", "map", "size", "insert", "find",
+              "erase", "bytes");
+  for (std::size_t n : {1'000, 100'000, 1'000'000}) {
+    std::vector<int> keys(n), probes(4'000'000);
+    for (int& k : keys)
+      k = rng();
+    for (int& k : probes)
+      k = rng() % 2 ? keys[rng() % n] : int(rng());
+    run<Map<int, int>>("Map", keys, probes);
+    run<HashedMap<int, int>>("Hashed", keys, probes);
+  }
+}
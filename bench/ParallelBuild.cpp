@@ -0,0 +1,54 @@
+#include "Set.hpp"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Milliseconds to build a Set and a MultiSet from 4M unsorted ints, with the
+// insert loop as the baseline and Parallel{threads} for growing thread
+// counts. Run it on an optimized build of a machine with several cores.
+int main() {
+  const auto time = [](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  std::mt19937 rng(35);
+  std::vector<int> keys(4'000'000);
+  for (int& k : keys)
+    k = rng() % 8'000'000;
+
+  // The containers outlive the timed part, so freeing them is not counted.
+  Set<int> set;
+  MultiSet<int> multiset;
+  const double set_loop = time([&] {
+    for (int k : keys)
+      set.insert(k);
+  });
+  const double multiset_loop = time([&] {
+    for (int k : keys)
+      multiset.insert(k);
+  });
+  std::printf("%-8s %8s %8s\n", "threads", "set", "multiset");
+  std::printf("%-8s %8.1f %8.1f\n", "loop", set_loop, multiset_loop);
+
+  std::vector<std::size_t> counts = {1, 2, 4, 8, 16};
+  const std::size_t cores = std::thread::hardware_concurrency();
+  if (cores > 16)
+    counts.push_back(cores);
+  for (std::size_t threads : counts) {
+    set.clear();
+    multiset.clear();
+    const double set_build = time([&] {
+      set = Set<int>(Parallel{threads}, keys.begin(), keys.end());
+    });
+    const double multiset_build = time([&] {
+      multiset = MultiSet<int>(Parallel{threads}, keys.begin(), keys.end());
+    });
+    std::printf("%-8zu %8.1f %8.1f\n", threads, set_build, multiset_build);
+  }
+  std::printf("(%zu cores, %zu elements)\n", cores, set.size());
+}
@@ -0,0 +1,64 @@
+#include "Map.hpp"
+#include "SeparatedMap.hpp"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Milliseconds for 1M inserts, 4M lookups and a full in-order walk, with the
+// mapped value inline in a Map node or out of line in a SeparatedMap, for
+// growing value sizes. Run it on an optimized build.
+template <std::size_t Bytes>
+struct Value {
+  std::array<char, Bytes> bytes{};
+};
+
+template <class Container>
+void run(const char* name, std::size_t bytes, const std::vector<int>& keys,
+         const std::vector<int>& probes) {
+  const auto time = [](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  std::size_t sink = 0;
+  Container m;
+  const double insert = time([&] {
+    for (int k : keys)
+      sink += m[k].bytes[0];
+  });
+  const double find = time([&] {
+    for (int k : probes)
+      sink += m.find(k) != m.end();
+  });
+  const double walk = time([&] {
+    for (auto&& [k, v] : m)
+      sink += v.bytes[0] + k;
+  });
+  std::printf("%-10s %6zu %8.1f %8.1f %8.1f   (%zu)\n", name, bytes, insert,
+              find, walk, sink);
+}
+
+template <std::size_t Bytes>
+void run_both(const std::vector<int>& keys, const std::vector<int>& probes) {
+  run<Map<int, Value<Bytes>>>("Map", Bytes, keys, probes);
+  run<SeparatedMap<int, Value<Bytes>>>("Separated", Bytes, keys, probes);
+}
+
+int main() {
+  std::mt19937 rng(39);
+  std::vector<int> keys(1'000'000), probes(4'000'000);
+  for (int& k : keys)
+    k = rng();
+  // Half of the lookups hit.
+  for (int& k : probes)
+    k = rng() % 2 ? keys[rng() % keys.size()] : int(rng());
+  std::printf("%-10s %6s %8s %8s %8s\n", "container", "bytes", "insert",
+              "find", "walk");
+  run_both<8>(keys, probes);
+  run_both<64>(keys, probes);
+  run_both<256>(keys, probes);
+}
@@ -0,0 +1,52 @@
+#include "Map.hpp"
+#include <chrono>
+#include <cstdio>
+
+// Milliseconds for 4M steps of a sliding window over increasing keys, held
+// at a steady size: insert and erase(begin()) per step, push_back and
+// pop_front() per step, and push_back per step with pop_front(64) every 64
+// steps. Run it on an optimized build.
+int main() {
+  const auto time = [](auto&& f) {
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  };
+  constexpr long steps = 4'000'000;
+  std::size_t sink = 0;
+  std::printf("%-8s %8s %8s %8s\n", "window", "insert", "push", "batched");
+  for (long window : {1'000, 100'000, 1'000'000}) {
+    // Each run starts from a full window, so only the steady state is timed.
+    const auto filled = [&] {
+      Map<long, long> m;
+      for (long t = 0; t < window; ++t)
+        m.push_back({t, t});
+      return m;
+    };
+    Map<long, long> a = filled(), b = filled(), c = filled();
+    const double insert = time([&] {
+      for (long t = window; t < window + steps; ++t) {
+        a.insert({t, t});
+        a.erase(a.begin());
+      }
+    });
+    const double push = time([&] {
+      for (long t = window; t < window + steps; ++t) {
+        b.push_back({t, t});
+        b.pop_front();
+      }
+    });
+    const double batched = time([&] {
+      for (long t = window; t < window + steps; ++t) {
+        c.push_back({t, t});
+        if (t % 64 == 63)
+          sink += c.pop_front(64);
+      }
+    });
+    sink += a.size() + b.size() + c.size();
+    std::printf("%-8ld %8.1f %8.1f %8.1f\n", window, insert, push, batched);
+  }
+  std::printf("(%zu)\n", sink);
+}
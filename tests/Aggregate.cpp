@@ -0,0 +1,91 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+
+struct Stats {
+  struct value_type {
+    long sum;
+    long max;
+    std::size_t count;
+    bool operator==(const value_type&) const = default;
+  };
+  static value_type identity() {
+    return {0, -1, 0};
+  }
+  static value_type lift(const std::pair<const int, long>& p) {
+    return {p.second, p.second, 1};
+  }
+  static value_type combine(value_type a, value_type b) {
+    return {a.sum + b.sum, std::max(a.max, b.max), a.count + b.count};
+  }
+};
+
+struct Count {
+  using value_type = std::size_t;
+  static value_type identity() {
+    return 0;
+  }
+  static value_type lift(const int&) {
+    return 1;
+  }
+  static value_type combine(value_type a, value_type b) {
+    return a + b;
+  }
+};
+
+int main() {
+  std::mt19937 rng(28);
+  AugmentedMultiMap<int, long, Stats> m;
+  std::multimap<int, long> r;
+  for (int step = 0; step < 20000; ++step) {
+    const int k = rng() % 500;
+    const long v = rng() % 100;
+    switch (rng() % 4) {
+    case 0:
+    case 1:
+      m.insert({k, v});
+      r.insert({k, v});
+      break;
+    case 2:
+      CHECK(m.erase(k) == r.erase(k));
+      break;
+    default: {
+      int lo = rng() % 500, hi = rng() % 500;
+      if (lo > hi)
+        std::swap(lo, hi);
+      Stats::value_type expected = Stats::identity();
+      for (auto i = r.lower_bound(lo); i != r.lower_bound(hi); ++i)
+        expected = Stats::combine(expected, Stats::lift(*i));
+      CHECK(m.aggregate(lo, hi) == expected);
+      CHECK(m.aggregate(m.lower_bound(lo), m.lower_bound(hi)) == expected);
+
+      const long target = rng() % 5000;
+      const auto p = m.prefix_search(
+          [&](const Stats::value_type& s) { return s.sum > target; });
+      long running = 0;
+      auto q = r.begin();
+      for (; q != r.end(); ++q)
+        if ((running += q->second) > target)
+          break;
+      CHECK((p == m.end()) == (q == r.end()));
+      if (q != r.end())
+        CHECK(p->first == q->first &&
+              m.aggregate(m.begin(), std::next(p)).sum == running);
+    }
+    }
+    if (step % 1000 == 0)
+      CHECK(m.verify());
+  }
+  long total = 0;
+  for (auto& [k, v] : r)
+    total += v;
+  CHECK(m.aggregate().sum == total && m.aggregate().count == r.size());
+
+  AugmentedSet<int, Count> s = {5, 1, 9, 3};
+  CHECK(s.aggregate(2, 9) == 2 && s.aggregate() == 4);
+  CHECK(*s.prefix_search([](std::size_t c) { return c > 2; }) == 5);
+  CHECK(s.prefix_search([](std::size_t c) { return c > 4; }) == s.end());
+}
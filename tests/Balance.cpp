@@ -0,0 +1,73 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+
+struct Sum {
+  using value_type = long;
+  static long identity() {
+    return 0;
+  }
+  static long lift(const std::pair<const int, long>& p) {
+    return p.second;
+  }
+  static long combine(long a, long b) {
+    return a + b;
+  }
+};
+
+template <class Balance>
+void run(std::mt19937& rng) {
+  BasicMap<int, long, std::less<int>, false, Sum, Balance> m;
+  std::multimap<int, long> r;
+  for (int step = 0; step < 30000; ++step) {
+    const int k = rng() % 800;
+    switch (rng() % 5) {
+    case 0:
+    case 1:
+      m.insert({k, long(step)});
+      r.insert({k, long(step)});
+      break;
+    case 2:
+      CHECK(m.erase(k) == r.erase(k));
+      break;
+    case 3: {
+      const int hi = k + rng() % 40;
+      m.erase(m.lower_bound(k), m.lower_bound(hi));
+      r.erase(r.lower_bound(k), r.lower_bound(hi));
+      break;
+    }
+    default: {
+      CHECK((m.find(k) == m.end()) == (r.find(k) == r.end()));
+      CHECK(m.count(k) == r.count(k));
+      long sum = 0;
+      for (auto i = r.lower_bound(k); i != r.lower_bound(k + 100); ++i)
+        sum += i->second;
+      CHECK(m.aggregate(k, k + 100) == sum);
+    }
+    }
+    if (step % 500 == 0) {
+      CHECK(m.verify());
+      CHECK(std::equal(m.begin(), m.end(), r.begin(), r.end()));
+    }
+  }
+  const auto copy = m;
+  CHECK(copy.verify() && std::equal(copy.begin(), copy.end(), r.begin(),
+                                    r.end()));
+
+  BasicSet<int, std::less<int>, true, NoAugment, Balance> ascending;
+  for (int i = 0; i < 100000; ++i)
+    ascending.insert(i);
+  for (int i = 0; i < 100000; i += 7)
+    CHECK(*ascending.find(i) == i);
+  CHECK(ascending.verify() && ascending.size() == 100000);
+}
+
+int main() {
+  std::mt19937 rng(30);
+  run<RedBlack>(rng);
+  run<Avl>(rng);
+  run<Treap>(rng);
+  run<Splay>(rng);
+}
@@ -0,0 +1,66 @@
+#include "BufferedMap.hpp"
+#include "Check.hpp"
+#include <map>
+#include <random>
+#include <string>
+
+int main() {
+  std::mt19937 rng(40);
+  for (auto policy : {MergePolicy::Auto, MergePolicy::Hinted,
+                      MergePolicy::Rebuild}) {
+    for (std::size_t capacity : {1, 7, 64, 1000}) {
+      BufferedMap<int, std::string> m(capacity, policy);
+      std::map<int, std::string> r;
+      for (int step = 0; step < 20000; ++step) {
+        // Few keys, so that one buffer often holds several writes to the
+        // same key and their order matters.
+        const int k = rng() % (step % 2 ? 3000 : 20);
+        const auto op = rng() % 20;
+        if (op < 6) {
+          m.insert({k, std::to_string(step)});
+          r.insert({k, std::to_string(step)});
+        } else if (op < 10) {
+          m.insert_or_assign(k, std::to_string(-step));
+          r.insert_or_assign(k, std::to_string(-step));
+        } else if (op < 15) {
+          m.erase(k);
+          r.erase(k);
+        } else if (op < 19) {
+          const auto it = m.find(k);
+          const auto rt = r.find(k);
+          CHECK(it == m.end() ? rt == r.end() : it->second == rt->second);
+          CHECK(m.contains(k) == r.contains(k) && m.count(k) == r.count(k));
+        } else {
+          CHECK(m.size() == r.size() && m.verify());
+          CHECK(std::equal(m.begin(), m.end(), r.begin(), r.end()));
+          const auto lb = m.lower_bound(k);
+          const auto rlb = r.lower_bound(k);
+          CHECK(lb == m.end() ? rlb == r.end() : lb->first == rlb->first);
+          const auto ub = m.upper_bound(k);
+          const auto rub = r.upper_bound(k);
+          CHECK(ub == m.end() ? rub == r.end() : ub->first == rub->first);
+        }
+        CHECK(m.buffered() < m.buffer_capacity());
+      }
+      CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+
+      auto copy = m;
+      copy.erase(r.begin()->first);
+      CHECK(copy.size() + 1 == m.size());
+      m.clear();
+      CHECK(m.empty() && m.verify());
+    }
+  }
+
+  // Writes to one key within a single buffer apply in call order.
+  BufferedMap<int, int> m(64, MergePolicy::Hinted);
+  m.insert({1, 1});
+  m.erase(1);
+  m.insert({1, 2});
+  m.insert({1, 3});
+  m.insert_or_assign(2, 4);
+  m.insert_or_assign(2, 5);
+  m.insert({2, 6});
+  m.erase(3);
+  CHECK(m.at(1) == 2 && m.at(2) == 5 && m.size() == 2);
+}
@@ -0,0 +1,17 @@
+#ifndef CHECK_HPP
+#define CHECK_HPP
+
+#include <cstdio>
+#include <cstdlib>
+
+// Aborts with the failing expression, so that ctest reports the test.
+#define CHECK(condition)                                                      \
+  do {                                                                        \
+    if (!(condition)) {                                                       \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,   \
+                   #condition);                                               \
+      std::abort();                                                           \
+    }                                                                         \
+  } while (false)
+
+#endif
@@ -0,0 +1,84 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+struct Sum {
+  using value_type = long;
+  static long identity() {
+    return 0;
+  }
+  static long lift(const std::pair<const int, int>& p) {
+    return p.first;
+  }
+  static long combine(long a, long b) {
+    return a + b;
+  }
+};
+
+int main() {
+  std::mt19937 rng(38);
+  for (int round = 0; round < 30; ++round) {
+    Map<int, std::string> m;
+    std::map<int, std::string> r;
+    MultiSet<int> ms;
+    std::multiset<int> rms;
+    AugmentedMap<int, int, Sum> am;
+    for (int step = 0; step < 5000; ++step) {
+      const int k = rng() % 3000;
+      const auto op = rng() % 10;
+      if (op < 5) {
+        // Long enough to live outside the node.
+        const std::string v = std::to_string(k) + std::string(20, '.');
+        m.insert({k, v});
+        r.insert({k, v});
+        ms.insert(k);
+        rms.insert(k);
+        am.insert({k, 1});
+      } else if (op < 8) {
+        m.erase(k);
+        r.erase(k);
+        ms.erase(k);
+        rms.erase(k);
+        am.erase(k);
+      } else if (rng() % 50 == 0) {
+        m.compact();
+        ms.compact();
+        am.compact();
+        CHECK(m.verify() && ms.verify() && am.verify());
+      } else if (rng() % 200 == 0) {
+        const auto copy = m;
+        m = copy;
+        Map<int, std::string> moved(std::move(m));
+        m = std::move(moved);
+      }
+    }
+    m.compact();
+    ms.compact();
+    am.compact();
+    CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+    CHECK(std::equal(m.rbegin(), m.rend(), r.rbegin(), r.rend()));
+    CHECK(ms.verify() && std::equal(ms.begin(), ms.end(), rms.begin(),
+                                    rms.end()));
+    long total = 0;
+    for (auto& [k, v] : r)
+      total += k;
+    CHECK(am.verify() && am.aggregate() == total);
+    for (auto& [k, v] : r)
+      CHECK(m.find(k)->second == v);
+    // Erasing from and inserting into a compacted map mixes both kinds of
+    // node.
+    for (int i = 0; i < 1000; ++i) {
+      const int k = rng() % 3000;
+      CHECK(m.erase(k) == r.erase(k));
+      m.insert({k + 3000, "x"});
+      r.insert({k + 3000, "x"});
+    }
+    CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+    if (round % 3 == 0)
+      m.clear();
+  }
+}
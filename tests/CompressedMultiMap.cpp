@@ -0,0 +1,104 @@
+#include "Check.hpp"
+#include "CompressedMultiMap.hpp"
+#include <map>
+#include <random>
+#include <ranges>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+template <class A, class B>
+bool same(const A& a, const B& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const auto& x, const auto& y) {
+                      return x.first == y.first && x.second == y.second;
+                    });
+}
+
+int main() {
+  std::mt19937 rng(41);
+  CompressedMultiMap<std::string, int> m;
+  std::multimap<std::string, int> r;
+  for (int step = 0; step < 30000; ++step) {
+    const std::string k = "key" + std::to_string(rng() % 300);
+    const auto op = rng() % 20;
+    if (op < 12) {
+      const auto it = m.insert({k, step});
+      r.insert({k, step});
+      CHECK(it->first == k && it->second == step);
+    } else if (op < 13) {
+      CHECK(m.erase(k) == r.erase(k));
+    } else if (op < 16) {
+      auto it = m.find(k);
+      auto rt = r.find(k);
+      if (rt == r.end()) {
+        CHECK(it == m.end());
+        continue;
+      }
+      const auto skip = rng() % r.count(k);
+      std::advance(it, skip);
+      std::advance(rt, skip);
+      CHECK(it->second == rt->second);
+      const auto next = m.erase(it);
+      const auto rnext = r.erase(rt);
+      CHECK(next == m.end() ? rnext == r.end()
+                            : next->first == rnext->first &&
+                                  next->second == rnext->second);
+    } else if (op < 18) {
+      CHECK(m.count(k) == r.count(k));
+      const auto [first, last] = m.equal_range(k);
+      const auto [rfirst, rlast] = r.equal_range(k);
+      CHECK(same(std::ranges::subrange(first, last),
+                 std::ranges::subrange(rfirst, rlast)));
+    } else {
+      const auto ub = m.upper_bound(k);
+      const auto rub = r.upper_bound(k);
+      CHECK(ub == m.end() ? rub == r.end()
+                          : ub->first == rub->first &&
+                                ub->second == rub->second);
+    }
+    if (step % 1000 == 0)
+      CHECK(m.verify());
+  }
+  CHECK(m.size() == r.size() && m.verify() && same(m, r));
+  std::vector<std::pair<std::string, int>> reversed(m.rbegin(), m.rend());
+  CHECK(same(reversed, std::ranges::subrange(r.rbegin(), r.rend())));
+
+  for (auto&& [k, v] : m)
+    ++v;
+  for (auto& [k, v] : r)
+    ++v;
+  CHECK(same(m, r));
+  auto copy = m;
+  CHECK(copy == m);
+  copy.erase(copy.begin());
+  CHECK(!(copy == m) && copy.verify());
+
+  CompressedMultiMap<int, int> il{{1, 2}, {1, 3}, {0, 9}};
+  CHECK(il.size() == 3 && il.key_count() == 2 && il.begin()->second == 9);
+  CHECK(il.values(1).size() == 2 && il.values(1)[1] == 3);
+
+  // A value that fails to copy leaves no empty bucket behind for its key.
+  struct Fragile {
+    bool fail;
+    explicit Fragile(bool fail) : fail(fail) {}
+    Fragile(const Fragile& other) : fail(other.fail) {
+      if (fail)
+        throw std::runtime_error("copy");
+    }
+  };
+  CompressedMultiMap<int, Fragile> fm;
+  fm.insert({1, Fragile(false)});
+  for (int key : {1, 2}) {
+    std::pair<const int, Fragile> bad(key, Fragile(false));
+    bad.second.fail = true;
+    bool thrown = false;
+    try {
+      fm.insert(bad);
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    CHECK(thrown && fm.verify() && fm.size() == 1 && fm.key_count() == 1);
+  }
+}
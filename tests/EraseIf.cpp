@@ -0,0 +1,130 @@
+#include "Check.hpp"
+#include "IntervalMap.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+struct Sum {
+  using value_type = long;
+  static long identity() {
+    return 0;
+  }
+  static long lift(const std::pair<const int, int>& p) {
+    return p.second;
+  }
+  static long combine(long a, long b) {
+    return a + b;
+  }
+};
+
+template <class Container, class Reference, class Pred>
+void check_erase_if(Container& c, Reference r, Pred pred) {
+  const auto erased = std::erase_if(r, pred);
+  CHECK(erase_if(c, pred) == erased);
+  CHECK(c.verify() && c.size() == r.size());
+  CHECK(std::equal(c.begin(), c.end(), r.begin(), r.end(),
+                   [](const auto& a, const auto& b) { return a == b; }));
+}
+
+int main() {
+  std::mt19937 rng(47);
+  for (int round = 0; round < 300; ++round) {
+    // Match ratios from none to all, on both sides of the rebuild cutoff.
+    const int n = rng() % 2000, mod = 1 + rng() % 100, cut = rng() % (mod + 1);
+    const auto pred = [&](const auto& p) {
+      return unsigned(p.second) % mod < unsigned(cut);
+    };
+    const auto key_pred = [&](int k) { return k % mod < cut; };
+    Map<int, int> m;
+    MultiMap<int, int> mm;
+    HashedMap<int, int> hm;
+    SmallMap<int, int, 8> sm;
+    AugmentedMap<int, int, Sum> am;
+    Set<int> s;
+    MultiSet<int> ms;
+    std::map<int, int> r;
+    std::multimap<int, int> rm;
+    for (int i = 0; i < n; ++i) {
+      const int k = rng() % 5000, v = rng();
+      m[k] = hm[k] = sm[k] = r[k] = v;
+      am.insert_or_assign(k, v);
+      mm.insert({k % 300, v});
+      rm.insert({k % 300, v});
+      s.insert(k);
+      ms.insert(k % 300);
+    }
+    check_erase_if(m, r, pred);
+    check_erase_if(hm, r, pred);
+    check_erase_if(sm, r, pred);
+    check_erase_if(am, r, pred);
+    check_erase_if(mm, rm, pred);
+    check_erase_if(s, std::set<int>(s.begin(), s.end()), key_pred);
+    check_erase_if(ms, std::multiset<int>(ms.begin(), ms.end()), key_pred);
+    std::erase_if(r, pred);
+    for (int k = 0; k < 5000; ++k)
+      CHECK(hm.contains(k) == r.contains(k));
+    long total = 0;
+    for (auto& [k, v] : r)
+      total += v;
+    CHECK(am.aggregate() == total);
+
+    // The rebuilt tree keeps working for later updates.
+    for (int i = 0; i < 100; ++i) {
+      const int k = rng() % 5000;
+      m.erase(k);
+      r.erase(k);
+      m[k + 1] = r[k + 1] = i;
+    }
+    CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+
+    IntervalMap<int, int> im;
+    std::vector<std::pair<Interval<int>, int>> intervals;
+    for (int i = 0; i < n / 10; ++i) {
+      const int start = rng() % 1000, end = start + 1 + rng() % 50;
+      im.insert({start, end}, i);
+      intervals.push_back({{start, end}, i});
+    }
+    const auto interval_pred = [&](const auto& p) {
+      return p.second % mod < cut;
+    };
+    const auto erased = std::erase_if(intervals, interval_pred);
+    CHECK(erase_if(im, interval_pred) == erased);
+    CHECK(im.verify() && im.size() == intervals.size());
+    std::size_t stabbed = 0, expected = 0;
+    for (auto& p : im.stabbing(500))
+      stabbed += p.first.start <= 500 && 500 < p.first.end;
+    for (auto& [interval, id] : intervals)
+      expected += interval.start <= 500 && 500 < interval.end;
+    CHECK(stabbed == expected);
+  }
+
+  // A pred that throws part way leaves the container and its index as they
+  // were, even after it has matched some elements.
+  HashedMap<int, int> hm;
+  HashedSet<int> hs;
+  for (int k = 0; k < 1000; ++k)
+    hm[k] = k, hs.insert(k);
+  const auto throws = [](auto& c, auto key) {
+    int seen = 0;
+    try {
+      erase_if(c, [&](const auto& e) {
+        if (++seen == 500)
+          throw std::runtime_error("pred");
+        return key(e) % 2 == 0;
+      });
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+    return false;
+  };
+  CHECK(throws(hm, [](const auto& p) { return p.first; }));
+  CHECK(throws(hs, [](int k) { return k; }));
+  CHECK(hm.size() == 1000 && hm.verify());
+  CHECK(hs.size() == 1000 && hs.verify());
+  for (int k = 0; k < 1000; ++k)
+    CHECK(hm.contains(k) && hm.find(k)->second == k && hs.contains(k));
+}
@@ -0,0 +1,61 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+
+// Every finger, including end(), must give the same answer as a search from
+// the root.
+template <class Container, class Reference>
+void run(std::mt19937& rng, int span, int n) {
+  Container c;
+  Reference r;
+  for (int i = 0; i < n; ++i) {
+    const int k = rng() % span;
+    c.insert(k);
+    r.insert(k);
+  }
+  const auto& cc = c;
+  for (int i = 0; i < 20000; ++i) {
+    const int k = int(rng() % (span + 2)) - 1;
+    const auto finger = rng() % 10 == 0 ? c.end() : c.lower_bound(rng() % span);
+    const auto lb = c.lower_bound_from(finger, k);
+    const auto rlb = r.lower_bound(k);
+    CHECK(lb == c.lower_bound(k));
+    CHECK(lb == c.end() ? rlb == r.end() : *lb == *rlb);
+    CHECK(c.upper_bound_from(finger, k) == c.upper_bound(k));
+    CHECK(c.find_from(finger, k) == c.find(k));
+    CHECK(cc.lower_bound_from(finger, k) == cc.lower_bound(k));
+  }
+  CHECK(c.verify());
+}
+
+int main() {
+  std::mt19937 rng(43);
+  for (int span : {1, 2, 10, 1000}) {
+    run<Set<int>, std::set<int>>(rng, span, span / 2 + 1);
+    run<MultiSet<int>, std::multiset<int>>(rng, span, span * 2);
+    run<SmallSet<int, 8>, std::set<int>>(rng, span, 6);
+    run<AvlSet<int>, std::set<int>>(rng, span, span);
+    run<SplaySet<int>, std::set<int>>(rng, span, span);
+  }
+
+  Set<int> empty;
+  CHECK(empty.lower_bound_from(empty.end(), 3) == empty.end());
+  CHECK(empty.find_from(empty.begin(), 1) == empty.end());
+  Map<int, int> m{{1, 1}, {3, 3}};
+  m.find_from(m.begin(), 3)->second = 4;
+  CHECK(m[3] == 4);
+
+  // A merge join walks the probes in order, with the previous match as the
+  // finger.
+  Map<int, int> big;
+  for (int i = 0; i < 100000; ++i)
+    big.insert({2 * i, i});
+  auto finger = big.begin();
+  for (int probe = 0; probe < 200000; probe += 1 + rng() % 50) {
+    finger = big.lower_bound_from(finger, probe);
+    CHECK(finger == big.lower_bound(probe));
+  }
+}
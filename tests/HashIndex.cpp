@@ -0,0 +1,91 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+int main() {
+  std::mt19937 rng(44);
+  HashedMap<int, std::string> m;
+  std::map<int, std::string> r;
+  HashedSet<int> s;
+  std::set<int> rs;
+  for (int step = 0; step < 60000; ++step) {
+    const int k = rng() % 3000;
+    const std::string v = std::to_string(step);
+    const auto op = rng() % 24;
+    if (op < 4) {
+      CHECK(m.insert({k, v}).second == r.insert({k, v}).second);
+      s.insert(k);
+      rs.insert(k);
+    } else if (op < 6) {
+      m[k] = v;
+      r[k] = v;
+    } else if (op < 7) {
+      m.insert_or_assign(k, v);
+      r.insert_or_assign(k, v);
+    } else if (op < 8) {
+      m.insert(m.lower_bound(k), {k, v});
+      r.insert(r.lower_bound(k), {k, v});
+      s.insert(s.lower_bound(k), k);
+      rs.insert(k);
+    } else if (op < 11) {
+      CHECK(m.erase(k) == r.erase(k));
+      CHECK(s.erase(k) == rs.erase(k));
+    } else if (op < 12) {
+      const auto it = m.lower_bound(k);
+      if (it != m.end()) {
+        r.erase(it->first);
+        m.erase(it);
+      }
+    } else if (op < 13) {
+      const int hi = k + rng() % 200;
+      m.erase(m.lower_bound(k), m.lower_bound(hi));
+      r.erase(r.lower_bound(k), r.lower_bound(hi));
+      s.erase(s.lower_bound(k), s.lower_bound(hi));
+      rs.erase(rs.lower_bound(k), rs.lower_bound(hi));
+    } else if (op < 20) {
+      const auto it = m.find(k);
+      const auto rt = r.find(k);
+      CHECK(it == m.end() ? rt == r.end() : it->second == rt->second);
+      CHECK(m.count(k) == r.count(k) && m.contains(k) == r.contains(k));
+      CHECK(s.contains(k) == rs.contains(k));
+      const auto& cm = m;
+      CHECK((cm.find(k) == cm.end()) == (rt == r.end()));
+    } else if (op < 21 && rng() % 20 == 0) {
+      const auto copy = m;
+      m = copy;
+      m.compact();
+      auto moved = s;
+      s = std::move(moved);
+      s.compact();
+    } else if (op < 22 && rng() % 40 == 0) {
+      const std::vector<std::pair<int, std::string>> v(r.begin(), r.end());
+      m = HashedMap<int, std::string>(Parallel{2}, v.begin(), v.end());
+    } else if (op < 23 && rng() % 100 == 0) {
+      m.clear();
+      r.clear();
+      s.clear();
+      rs.clear();
+    }
+    if (step % 1000 == 0)
+      CHECK(m.verify() && s.verify());
+  }
+  CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+  CHECK(s.verify() && std::equal(s.begin(), s.end(), rs.begin(), rs.end()));
+
+  HashedMap<std::string, int> sm{{"a", 1}, {"b", 2}};
+  sm.assign(sm.begin(), sm.begin());
+  CHECK(sm.empty() && sm.verify());
+  sm = {{"c", 3}};
+  CHECK(sm["c"] == 3 && !sm.contains("a") && sm.verify());
+  HashedMap<std::string, int> moved(std::move(sm));
+  CHECK(moved.verify() && sm.verify() && !sm.contains("c"));
+
+  // The transparent less-than is accepted alongside std::less<Key>.
+  HashedSet<std::string, std::less<>> ts{"x", "y"};
+  CHECK(ts.contains("x") && ts.erase(std::string("y")) == 1 && ts.verify());
+}
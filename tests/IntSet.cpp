@@ -0,0 +1,100 @@
+#include "Check.hpp"
+#include "IntSet.hpp"
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <limits>
+#include <set>
+#include <stdexcept>
+
+template <class Key>
+bool same(const IntSet<Key>& a, const std::set<Key>& b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(),
+                                            b.end());
+}
+
+int main() {
+  std::mt19937 rng(42);
+  for (std::uint32_t span : {1u, 63u, 64u, 65u, 4096u, 300000u}) {
+    IntSet<> s;
+    std::set<std::uint32_t> r;
+    for (int step = 0; step < 20000; ++step) {
+      const std::uint32_t k = rng() % span;
+      const auto op = rng() % 10;
+      if (op < 5) {
+        const auto [it, inserted] = s.insert(k);
+        CHECK(inserted == r.insert(k).second && *it == k);
+      } else if (op < 7) {
+        CHECK(s.erase(k) == r.erase(k));
+      } else if (op < 8) {
+        const auto lb = s.lower_bound(k);
+        const auto rlb = r.lower_bound(k);
+        CHECK(lb == s.end() ? rlb == r.end() : *lb == *rlb);
+        const auto ub = s.upper_bound(k);
+        const auto rub = r.upper_bound(k);
+        CHECK(ub == s.end() ? rub == r.end() : *ub == *rub);
+      } else if (op < 9) {
+        const auto it = s.find(k);
+        CHECK((it == s.end()) == !r.count(k));
+        if (it != s.end()) {
+          const auto next = s.erase(it);
+          const auto rnext = r.erase(r.find(k));
+          CHECK(next == s.end() ? rnext == r.end() : *next == *rnext);
+        }
+      } else {
+        auto it = s.lower_bound(k);
+        auto rt = r.lower_bound(k);
+        if (rt != r.begin())
+          CHECK(*--it == *--rt);
+      }
+    }
+    CHECK(same(s, r));
+    CHECK(std::equal(s.rbegin(), s.rend(), r.rbegin(), r.rend()));
+
+    IntSet<> t;
+    std::set<std::uint32_t> rt;
+    for (int i = 0; i < 5000; ++i) {
+      const std::uint32_t k = rng() % (span * 2 + 1);
+      t.insert(k);
+      rt.insert(k);
+    }
+    std::set<std::uint32_t> united, common, difference;
+    std::set_union(r.begin(), r.end(), rt.begin(), rt.end(),
+                   std::inserter(united, united.end()));
+    std::set_intersection(r.begin(), r.end(), rt.begin(), rt.end(),
+                          std::inserter(common, common.end()));
+    std::set_difference(r.begin(), r.end(), rt.begin(), rt.end(),
+                        std::inserter(difference, difference.end()));
+    CHECK(same(s | t, united) && same(t | s, united));
+    CHECK(same(s & t, common) && same(t & s, common));
+    CHECK(same(s - t, difference));
+    auto u = s;
+    u |= t;
+    CHECK(same(u, united));
+    u &= t;
+    CHECK(same(u, rt) && u == t);
+    u -= s;
+    CHECK(same(t - s, std::set<std::uint32_t>(u.begin(), u.end())));
+
+    s.clear();
+    CHECK(s.empty() && s.begin() == s.end());
+  }
+
+  IntSet<std::uint64_t> wide{5, 1000000, 3};
+  CHECK(*wide.begin() == 3 && *std::prev(wide.end()) == 1000000);
+  CHECK(wide.size() == 3 && wide.contains(5) && !wide.contains(4));
+
+  // The largest 64-bit key is end()'s position: nothing follows it, and
+  // storing it is refused rather than aliasing end().
+  const std::uint64_t top = std::numeric_limits<std::uint64_t>::max();
+  CHECK(wide.upper_bound(top) == wide.end());
+  CHECK(wide.lower_bound(top) == wide.end() && !wide.contains(top));
+  CHECK(wide.upper_bound(top - 1) == wide.end());
+  bool thrown = false;
+  try {
+    wide.insert(top);
+  } catch (const std::length_error&) {
+    thrown = true;
+  }
+  CHECK(thrown && wide.size() == 3);
+}
@@ -0,0 +1,83 @@
+#include "Check.hpp"
+#include "IntervalMap.hpp"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+using Entry = std::pair<Interval<int>, int>;
+
+// Counts comparisons while staying stateless, as IntervalMap requires.
+struct Counting {
+  static inline long calls = 0;
+  bool operator()(int a, int b) const {
+    ++calls;
+    return a < b;
+  }
+};
+
+template <class Range>
+std::vector<int> ids(const Range& range) {
+  std::vector<int> result;
+  for (auto& [interval, id] : range)
+    result.push_back(id);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+int main() {
+  std::mt19937 rng(29);
+  IntervalMap<int, int> m;
+  std::vector<Entry> r;
+  for (int step = 0; step < 20000; ++step) {
+    const int op = rng() % 4;
+    if (op < 2) {
+      const int start = rng() % 1000, end = start + 1 + rng() % 50;
+      m.insert({start, end}, step);
+      r.push_back({{start, end}, step});
+    } else if (op == 2 && !r.empty()) {
+      auto it = std::next(m.begin(), rng() % m.size());
+      std::erase(r, Entry{it->first, it->second});
+      m.erase(it);
+    } else {
+      const int lo = rng() % 1000, hi = lo + rng() % 30;
+      std::vector<Entry> overlapping, stabbing;
+      for (auto& e : r) {
+        if (e.first.start < hi && lo < e.first.end)
+          overlapping.push_back(e);
+        if (e.first.start <= lo && lo < e.first.end)
+          stabbing.push_back(e);
+      }
+      CHECK(ids(m.overlapping(lo, hi)) == ids(overlapping));
+      CHECK(ids(m.overlapping({lo, hi})) == ids(overlapping));
+      CHECK(m.overlaps(lo, hi) == !overlapping.empty());
+      CHECK(ids(m.stabbing(lo)) == ids(stabbing));
+    }
+    if (step % 1000 == 0)
+      CHECK(m.verify());
+  }
+  CHECK(m.size() == r.size() && m.verify());
+
+  const int middle = m.begin()->first.start + 300;
+  m.erase(m.begin(), std::find_if(m.begin(), m.end(), [&](auto& e) {
+            return e.first.start >= middle;
+          }));
+  std::erase_if(r, [&](auto& e) { return e.first.start < middle; });
+  CHECK(m.verify() && ids(m.overlapping(0, 2000)) == ids(r));
+  m.clear();
+  CHECK(m.empty() && m.overlapping(0, 2000).empty());
+
+  // A query with k consecutive matches continues one in-order walk, so it
+  // costs O(log n + k) comparisons, not O(log n) per match.
+  IntervalMap<int, int, Counting> unit;
+  for (int i = 0; i < 1 << 16; ++i)
+    unit.insert({i, i + 1}, i);
+  for (int k : {0, 1, 10, 1000}) {
+    const int lo = rng() % (1 << 15);
+    Counting::calls = 0;
+    int found = 0;
+    for (auto& e : unit.overlapping(lo, lo + k))
+      found += e.second >= lo;
+    CHECK(found == k && Counting::calls <= 8 * (k + 2 * 17));
+  }
+}
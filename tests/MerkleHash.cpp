@@ -0,0 +1,71 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Summaries go stale through a mutable iterator, so none is handed out.
+static_assert(std::is_same_v<
+              decltype(std::declval<MerkleMap<int, int>&>()
+                           .insert_or_assign(1, 1)
+                           .first),
+              MerkleMap<int, int>::const_iterator>);
+
+int main() {
+  std::mt19937 rng(27);
+  for (int round = 0; round < 500; ++round) {
+    MerkleMap<int, int> a, b;
+    std::map<int, int> ra, rb;
+    const int n = rng() % 300;
+    for (int i = 0; i < n; ++i) {
+      const int k = rng() % 400, v = rng() % 3;
+      a.insert_or_assign(k, v);
+      ra[k] = v;
+    }
+    // The same contents inserted in another order give another shape.
+    std::vector<std::pair<int, int>> items(ra.begin(), ra.end());
+    std::shuffle(items.begin(), items.end(), rng);
+    for (auto [k, v] : items) {
+      b.insert_or_assign(k, v);
+      rb[k] = v;
+    }
+    for (int i = 0; i < 30; ++i) {
+      const int k = rng() % 400;
+      a.erase(k);
+      ra.erase(k);
+    }
+    a.erase(a.lower_bound(100), a.lower_bound(120));
+    ra.erase(ra.lower_bound(100), ra.lower_bound(120));
+    for (int i = rng() % 4; i > 0; --i) {
+      const int k = rng() % 400;
+      b.insert_or_assign(k, 7);
+      rb[k] = 7;
+    }
+    CHECK(a.verify() && b.verify());
+
+    std::vector<int> got, expected;
+    a.diff(b, [&](int k) { got.push_back(k); });
+    for (int k = 0; k < 400; ++k) {
+      const auto x = ra.find(k), y = rb.find(k);
+      if ((x == ra.end()) != (y == rb.end()) ||
+          (x != ra.end() && x->second != y->second))
+        expected.push_back(k);
+    }
+    std::sort(got.begin(), got.end());
+    CHECK(got == expected);
+    CHECK((a == b) == (ra == rb));
+  }
+
+  MerkleSet<int> s = {1, 2, 3}, t = {3, 2, 1, 4};
+  std::set<int> changed;
+  s.diff(t, [&](int k) { changed.insert(k); });
+  CHECK(changed == std::set<int>{4});
+  CHECK(!(s == t));
+  t.erase(4);
+  CHECK(s == t && s.verify() && t.verify());
+}
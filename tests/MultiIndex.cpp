@@ -0,0 +1,155 @@
+#include "Check.hpp"
+#include "MultiIndex.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Record {
+  int id;
+  int age;
+  std::string name;
+};
+
+struct ById {
+  int operator()(const Record& r) const {
+    return r.id;
+  }
+};
+
+struct ByAge {
+  int operator()(const Record& r) const {
+    return r.age;
+  }
+};
+
+struct ByName {
+  const std::string& operator()(const Record& r) const {
+    return r.name;
+  }
+};
+
+using Records = MultiIndex<Record, UniqueIndex<ById>,
+                           OrderedIndex<ByAge, std::greater<>>,
+                           UniqueIndex<ByName>>;
+
+// Compares every index with orderings rebuilt from a map by id.
+void check(const Records& m, const std::map<int, Record>& r) {
+  CHECK(m.size() == r.size() && m.verify());
+  const auto ids = m.get<0>();
+  CHECK(std::equal(ids.begin(), ids.end(), r.begin(), r.end(),
+                   [](const Record& a, const auto& b) {
+                     return a.id == b.first && a.age == b.second.age &&
+                            a.name == b.second.name;
+                   }));
+  std::multiset<int, std::greater<>> ages;
+  std::set<std::string> names;
+  for (auto& [id, record] : r) {
+    ages.insert(record.age);
+    names.insert(record.name);
+  }
+  const auto by_age = m.get<1>();
+  CHECK(std::equal(by_age.begin(), by_age.end(), ages.begin(), ages.end(),
+                   [](const Record& a, int b) { return a.age == b; }));
+  const auto by_name = m.get<2>();
+  CHECK(std::equal(by_name.begin(), by_name.end(), names.begin(), names.end(),
+                   [](const Record& a, const auto& b) { return a.name == b; }));
+  CHECK(std::equal(by_name.rbegin(), by_name.rend(), names.rbegin(),
+                   names.rend(),
+                   [](const Record& a, const auto& b) { return a.name == b; }));
+}
+
+int main() {
+  std::mt19937 rng(46);
+  Records m;
+  std::map<int, Record> r;
+  const auto name_taken = [&](const std::string& name, int except) {
+    for (auto& [id, record] : r)
+      if (id != except && record.name == name)
+        return true;
+    return false;
+  };
+  for (int step = 0; step < 20000; ++step) {
+    const int id = rng() % 300, age = rng() % 40;
+    const std::string name = "n" + std::to_string(rng() % 400);
+    const auto op = rng() % 6;
+    if (op < 3) {
+      const bool clash = r.count(id) || name_taken(name, -1);
+      const auto [it, inserted] = m.emplace(Record{id, age, name});
+      CHECK(inserted == !clash);
+      if (inserted)
+        r[id] = {id, age, name};
+      CHECK(it->id == id || it->name == name);
+    } else if (op == 3) {
+      CHECK(m.get<0>().erase(id) == r.erase(id));
+    } else if (op == 4) {
+      std::size_t count = 0;
+      for (auto& [key, record] : r)
+        count += record.age == age;
+      CHECK(m.get<1>().count(age) == count);
+      for (auto [first, last] = m.get<1>().equal_range(age); first != last;
+           ++first)
+        CHECK(first->age == age);
+      const auto it = m.get<2>().find(name);
+      if (it == m.get<2>().end()) {
+        CHECK(m.project<0>(it) == m.get<0>().end());
+        continue;
+      }
+      const auto p = m.project<0>(it);
+      CHECK(&*p == &*it && it->name == name);
+      r.erase(p->id);
+      m.get<2>().erase(it);
+    } else {
+      const auto it = m.get<0>().find(id);
+      if (it == m.get<0>().end())
+        continue;
+      const bool clash = name_taken(name, id);
+      const bool kept = m.modify(it, [&](Record& x) {
+        x.age = age;
+        x.name = name;
+      });
+      CHECK(kept == !clash);
+      if (kept)
+        r[id] = {id, age, name};
+      else
+        r.erase(id);
+    }
+    if (step % 97 == 0)
+      check(m, r);
+  }
+  check(m, r);
+
+  // A throwing functor leaves the element erased from every index.
+  if (!r.empty()) {
+    const int id = r.begin()->first;
+    bool thrown = false;
+    try {
+      m.modify(m.get<0>().find(id), [](Record& x) {
+        x.age = -1;
+        throw std::runtime_error("modify");
+      });
+    } catch (const std::runtime_error&) {
+      thrown = true;
+    }
+    r.erase(id);
+    CHECK(thrown);
+    check(m, r);
+  }
+
+  Records copy = m;
+  check(copy, r);
+  Records moved = std::move(copy);
+  check(moved, r);
+  CHECK(copy.empty() && copy.verify());
+  copy = moved;
+  check(copy, r);
+  auto& alias = copy;
+  copy = std::move(alias);
+  check(copy, r);
+  moved.clear();
+  CHECK(moved.empty() && moved.get<1>().begin() == moved.get<1>().end());
+  const Records& cm = m;
+  CHECK(cm.get<0>().lower_bound(-1) == cm.get<0>().begin());
+}
@@ -0,0 +1,111 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <atomic>
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Counts live copies and throws from the copy that brings copies_left to
+// zero, wherever the worker thread making it is.
+struct Fragile {
+  static inline std::atomic<long> live = 0;
+  static inline std::atomic<long> copies_left = -1;
+  int key;
+
+  explicit Fragile(int key) : key(key) {
+    ++live;
+  }
+  Fragile(const Fragile& other) : key(other.key) {
+    if (--copies_left == 0)
+      throw std::runtime_error("copy");
+    ++live;
+  }
+  ~Fragile() {
+    --live;
+  }
+  bool operator<(const Fragile& other) const {
+    return key < other.key;
+  }
+};
+
+struct Sum {
+  using value_type = long;
+  static long identity() {
+    return 0;
+  }
+  static long lift(const std::pair<const int, int>& p) {
+    return p.first;
+  }
+  static long combine(long a, long b) {
+    return a + b;
+  }
+};
+
+int main() {
+  std::mt19937 rng(35);
+  for (int n : {0, 1, 2, 3, 7, 100, 20000, 70000, 200000}) {
+    std::vector<std::pair<int, int>> v;
+    for (int i = 0; i < n; ++i)
+      v.push_back({int(rng() % (n + 1)), i});
+    std::vector<int> keys;
+    for (auto& p : v)
+      keys.push_back(p.first);
+    const std::map<int, int> r(v.begin(), v.end());
+    const std::multimap<int, int> rm(v.begin(), v.end());
+    long total = 0;
+    for (auto& p : r)
+      total += p.first;
+
+    for (std::size_t threads : {1, 2, 3, 8}) {
+      const Parallel policy{threads};
+      const Map<int, int> m(policy, v.begin(), v.end());
+      CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+      const MultiMap<int, int> mm(policy, v.begin(), v.end());
+      CHECK(mm.verify() &&
+            std::equal(mm.begin(), mm.end(), rm.begin(), rm.end()));
+      const AugmentedMap<int, int, Sum> am(policy, v.begin(), v.end());
+      CHECK(am.verify() && am.aggregate() == total);
+      AvlSet<int> as(policy, keys.begin(), keys.end());
+      CHECK(as.verify() && as.size() == r.size());
+      SmallSet<int, 8> ss(policy, keys.begin(), keys.end());
+      CHECK(ss.verify() && std::equal(ss.begin(), ss.end(), as.begin(),
+                                      as.end()));
+      ss.insert(-1);
+      as.insert(-1);
+      CHECK(ss.verify() && as.verify() && ss.size() == as.size());
+    }
+
+    std::vector<std::string> strings;
+    for (int i = 0; i < n / 10; ++i)
+      strings.push_back(std::to_string(rng() % 1000));
+    Set<std::string> s(Parallel{4}, strings.begin(), strings.end());
+    const std::set<std::string> rs(strings.begin(), strings.end());
+    CHECK(s.verify() && std::equal(s.begin(), s.end(), rs.begin(), rs.end()));
+    s.insert("x");
+    s.erase(s.begin());
+    CHECK(s.verify());
+  }
+
+  // A copy that throws in one worker frees every node the others built.
+  {
+    std::vector<Fragile> input;
+    for (int i = 0; i < 100000; ++i)
+      input.emplace_back(int(rng() % 1000));
+    for (long fail : {1, 30000, 99999}) {
+      Fragile::copies_left = fail;
+      bool thrown = false;
+      try {
+        MultiSet<Fragile> fs(Parallel{4}, input.begin(), input.end());
+      } catch (const std::runtime_error&) {
+        thrown = true;
+      }
+      CHECK(thrown && Fragile::live == long(input.size()));
+    }
+    Fragile::copies_left = -1;
+  }
+  CHECK(Fragile::live == 0);
+}
@@ -0,0 +1,77 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <atomic>
+#include <random>
+#include <vector>
+
+template <class Container>
+void check_split(const Container& c, typename Container::const_iterator first,
+                 typename Container::const_iterator last, std::size_t n) {
+  const auto ranges = c.split_ranges(first, last, n);
+  CHECK(ranges.size() <= std::max<std::size_t>(n, 1));
+  if (first == last) {
+    CHECK(ranges.empty());
+    return;
+  }
+  CHECK(ranges.front().first == first && ranges.back().second == last);
+  std::ptrdiff_t total = 0;
+  for (std::size_t i = 0; i < ranges.size(); ++i) {
+    if (i > 0)
+      CHECK(ranges[i].first == ranges[i - 1].second);
+    const auto size = std::distance(ranges[i].first, ranges[i].second);
+    CHECK(size > 0);
+    total += size;
+  }
+  CHECK(total == std::distance(first, last));
+}
+
+int main() {
+  std::mt19937 rng(36);
+  for (int n : {0, 1, 2, 5, 50, 1000, 30000}) {
+    MultiMap<int, int> m;
+    for (int i = 0; i < n; ++i)
+      m.insert({int(rng() % (n / 3 + 1)), i});
+    for (std::size_t k : {1, 2, 3, 7, 16, 64, 1000}) {
+      check_split(m, m.cbegin(), m.cend(), k);
+      for (int trial = 0; trial < 5; ++trial) {
+        std::size_t a = rng() % (n + 1), b = rng() % (n + 1);
+        if (a > b)
+          std::swap(a, b);
+        check_split(m, std::next(m.cbegin(), a), std::next(m.cbegin(), b), k);
+      }
+    }
+
+    const std::vector<std::pair<int, int>> before(m.begin(), m.end());
+    std::atomic<long> sum = 0;
+    m.parallel_for_each(Parallel{4}, [&](auto& p) {
+      p.second += 1;
+      sum += p.first;
+    });
+    long expected = 0;
+    auto it = before.begin();
+    for (auto& [k, v] : m) {
+      expected += k;
+      CHECK(v == it++->second + 1);
+    }
+    CHECK(sum == expected);
+
+    const auto& cm = m;
+    std::atomic<int> seen = 0;
+    cm.parallel_for_each(Parallel{3}, cm.begin(), cm.end(),
+                         [&](const auto&) { ++seen; });
+    CHECK(seen == n);
+
+    Set<int> s;
+    for (int i = 0; i < n; ++i)
+      s.insert(i);
+    seen = 0;
+    s.parallel_for_each(Parallel{}, [&](int) { ++seen; });
+    CHECK(seen == n);
+
+    SmallSet<int, 8> small;
+    for (int i = 0; i < n % 9; ++i)
+      small.insert(i);
+    check_split(small, small.begin(), small.end(), 4);
+  }
+}
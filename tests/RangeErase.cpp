@@ -0,0 +1,63 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+template <class Container, class Reference>
+void erase_ranges(std::mt19937& rng, int span) {
+  for (int round = 0; round < 500; ++round) {
+    Container c;
+    Reference r;
+    const int n = rng() % (4 * span);
+    for (int i = 0; i < n; ++i) {
+      const int k = rng() % span;
+      c.insert({k, std::to_string(i)});
+      r.insert({k, std::to_string(i)});
+    }
+    for (int step = 0; step < 8; ++step) {
+      int lo = rng() % (span + 4) - 2, hi = rng() % (span + 4) - 2;
+      if (lo > hi)
+        std::swap(lo, hi);
+      const auto it = c.erase(c.lower_bound(lo), c.upper_bound(hi));
+      const auto rt = r.erase(r.lower_bound(lo), r.upper_bound(hi));
+      CHECK(it == c.end() ? rt == r.end() : it->first == rt->first);
+      CHECK(c.verify());
+      CHECK(std::equal(c.begin(), c.end(), r.begin(), r.end()));
+      const int k = rng() % span;
+      CHECK(c.erase(k) == r.erase(k));
+      for (int i = 0; i < 10; ++i) {
+        const int k = rng() % span;
+        c.insert({k, "x"});
+        r.insert({k, "x"});
+      }
+      CHECK(c.verify());
+    }
+    c.erase(c.begin(), c.end());
+    CHECK(c.empty() && c.verify());
+  }
+}
+
+int main() {
+  std::mt19937 rng(26);
+  for (int span : {1, 5, 50, 400}) {
+    erase_ranges<Map<int, std::string>, std::map<int, std::string>>(rng, span);
+    erase_ranges<MultiMap<int, std::string>,
+                 std::multimap<int, std::string>>(rng, span);
+  }
+
+  MultiSet<int> s;
+  std::multiset<int> r;
+  for (int i = 0; i < 100000; ++i) {
+    s.insert(i % 5000);
+    r.insert(i % 5000);
+  }
+  s.erase(s.lower_bound(100), s.lower_bound(4900));
+  r.erase(r.lower_bound(100), r.lower_bound(4900));
+  CHECK(s.verify());
+  CHECK(std::equal(s.begin(), s.end(), r.begin(), r.end()));
+  s.erase(s.begin(), s.find(4900));
+  CHECK(s.verify() && *s.begin() == 4900 && s.size() == 100 * 20);
+}
@@ -0,0 +1,77 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+static long allocations = 0;
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+  std::free(p);
+}
+
+int main() {
+  std::mt19937 rng(34);
+  for (int round = 0; round < 200; ++round) {
+    const int na = rng() % 300, nb = rng() % 300;
+    Map<int, int> a, b;
+    for (int i = 0; i < na; ++i)
+      a.insert({int(rng() % 1000), i});
+    for (int i = 0; i < nb; ++i)
+      b.insert({int(rng() % 1000), -i});
+    const std::map<int, int> expected(b.begin(), b.end());
+
+    // Every node of the target is reused before a new one is allocated.
+    const long before = allocations;
+    const long reusable = a.size();
+    a = b;
+    CHECK(allocations - before <= std::max(0L, long(b.size()) - reusable));
+    CHECK(a.verify() && b.verify());
+    CHECK(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+    const auto& self = a;
+    a = self;
+    CHECK(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+
+    std::vector<std::string> v;
+    for (int i = rng() % 300; i > 0; --i)
+      v.push_back(std::to_string(rng() % 100));
+    if (round % 2)
+      std::sort(v.begin(), v.end());
+    MultiSet<std::string> ms;
+    Set<std::string> s;
+    for (int i = 0; i < na; ++i) {
+      ms.insert(std::to_string(i % 50));
+      s.insert(std::to_string(i % 50));
+    }
+    ms.assign(v.begin(), v.end());
+    s.assign(v.begin(), v.end());
+    const std::multiset<std::string> rms(v.begin(), v.end());
+    const std::set<std::string> rs(v.begin(), v.end());
+    CHECK(ms.verify() && std::equal(ms.begin(), ms.end(), rms.begin(),
+                                    rms.end()));
+    CHECK(s.verify() && std::equal(s.begin(), s.end(), rs.begin(), rs.end()));
+  }
+
+  Map<int, int> m;
+  m = {{3, 4}, {1, 2}, {3, 5}};
+  CHECK(m.size() == 2 && m.at(3) == 4 && m.verify());
+  m = {};
+  CHECK(m.empty() && m.verify());
+}
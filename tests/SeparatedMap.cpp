@@ -0,0 +1,135 @@
+#include "Check.hpp"
+#include "SeparatedMap.hpp"
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+// Counts live objects, so that a leaked or doubly destroyed value shows.
+struct Tracked {
+  static inline int live = 0;
+  std::string s;
+
+  Tracked(std::string s = "") : s(std::move(s)) {
+    ++live;
+  }
+  Tracked(const Tracked& other) : s(other.s) {
+    ++live;
+  }
+  Tracked& operator=(const Tracked&) = default;
+  ~Tracked() {
+    --live;
+  }
+  bool operator==(const Tracked&) const = default;
+};
+
+// A key whose copy throws once fail is set.
+struct FragileKey {
+  int k;
+  bool fail = false;
+
+  FragileKey(int k) : k(k) {}
+  FragileKey(const FragileKey& other) : k(other.k) {
+    if (other.fail)
+      throw std::runtime_error("copy");
+  }
+  bool operator<(const FragileKey& other) const {
+    return k < other.k;
+  }
+};
+
+int main() {
+  std::mt19937 rng(39);
+  {
+    SeparatedMap<int, Tracked> m;
+    std::map<int, Tracked> r;
+    for (int step = 0; step < 20000; ++step) {
+      const int k = rng() % 2000;
+      const Tracked v(std::to_string(step));
+      switch (rng() % 8) {
+      case 0:
+      case 1:
+      case 2:
+        CHECK(m.insert({k, v}).second == r.insert({k, v}).second);
+        break;
+      case 3:
+        m[k] = v;
+        r[k] = v;
+        break;
+      case 4:
+        CHECK(m.insert_or_assign(k, v).second ==
+              r.insert_or_assign(k, v).second);
+        break;
+      case 5:
+      case 6:
+        CHECK(m.erase(k) == r.erase(k));
+        break;
+      default: {
+        const auto it = m.lower_bound(k);
+        const auto rt = r.lower_bound(k);
+        CHECK(it == m.end() ? rt == r.end()
+                            : it->first == rt->first &&
+                                  it->second == rt->second);
+        if (rt != r.end() && rng() % 2) {
+          m.erase(it);
+          r.erase(rt);
+        }
+      }
+      }
+      if (step % 5000 == 0) {
+        const auto copy = m;
+        CHECK(copy == m && copy.verify());
+        SeparatedMap<int, Tracked> other, moved;
+        other = copy;
+        moved = std::move(other);
+        CHECK(moved == m);
+        m.compact();
+        CHECK(m.verify());
+      }
+    }
+    CHECK(m.size() == r.size() && m.verify());
+    auto it = m.begin();
+    for (auto& [k, v] : r) {
+      CHECK(it->first == k && it->second == v);
+      ++it;
+    }
+    auto rit = m.rbegin();
+    for (auto rt = r.rbegin(); rt != r.rend(); ++rt, ++rit)
+      CHECK(rit->first == rt->first);
+    const auto& cm = m;
+    for (auto& [k, v] : r)
+      CHECK(cm.at(k) == v && cm.contains(k));
+    SeparatedMap<int, Tracked>::const_iterator ci = m.begin();
+    CHECK(ci == cm.begin());
+    m.clear();
+    CHECK(m.empty() && m.verify());
+    m[1] = Tracked("z");
+    CHECK(m.size() == 1);
+
+    auto& alias = m;
+    m = std::move(alias);
+    CHECK(m.verify() && m.size() == 1 && m.at(1) == Tracked("z"));
+  }
+  CHECK(Tracked::live == 0);
+
+  // The mapped value built for a key that fails to copy is released.
+  {
+    SeparatedMap<FragileKey, Tracked> f;
+    f.try_emplace(1, "a");
+    FragileKey bad(2);
+    bad.fail = true;
+    for (int attempt = 0; attempt < 3; ++attempt) {
+      bool thrown = false;
+      try {
+        f.try_emplace(bad, "b");
+      } catch (const std::runtime_error&) {
+        thrown = true;
+      }
+      CHECK(thrown && f.size() == 1 && f.verify() && Tracked::live == 1);
+    }
+  }
+  CHECK(Tracked::live == 0);
+
+  SeparatedMap<std::string, int> s{{"b", 2}, {"a", 1}};
+  CHECK(s.begin()->first == "a" && s["c"] == 0 && s.size() == 3);
+}
@@ -0,0 +1,84 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+struct Sum {
+  using value_type = long;
+  static long identity() {
+    return 0;
+  }
+  static long lift(const std::pair<const int, int>& p) {
+    return p.second;
+  }
+  static long combine(long a, long b) {
+    return a + b;
+  }
+};
+
+template <class Map, class Reference>
+void run(std::mt19937& rng) {
+  for (int round = 0; round < 200; ++round) {
+    Map m;
+    Reference r;
+    int t = 0;
+    for (int step = 0; step < 500; ++step) {
+      if (rng() % 10 < 7) {
+        // Mostly increasing keys, with some late ones.
+        const int k = rng() % 8 ? t += rng() % 3 : int(rng() % (t + 1));
+        const int v = rng();
+        const auto it = m.push_back({k, v});
+        const auto rt = r.insert({k, v});
+        if constexpr (requires { it.second; })
+          CHECK(it.second == rt.second && it.first->second == rt.first->second);
+        else
+          CHECK(it->second == rt->second);
+      } else {
+        const std::size_t n = rng() % 5 ? rng() % 4 : rng() % 100;
+        const std::size_t expected = std::min(n, r.size());
+        r.erase(r.begin(), std::next(r.begin(), expected));
+        CHECK(m.pop_front(n) == expected);
+      }
+      if (step % 50 == 0)
+        CHECK(m.verify());
+    }
+    CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+    std::vector<std::pair<int, int>> more;
+    for (int i = 0; i < 50; ++i)
+      more.push_back({t + 2 * i - 20, i});
+    m.append(more.begin(), more.end());
+    r.insert(more.begin(), more.end());
+    CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+    for (int i = 0; i < 50; ++i) {
+      const int k = rng() % (t + 200);
+      CHECK((m.find(k) == m.end()) == !r.count(k));
+    }
+  }
+}
+
+int main() {
+  std::mt19937 rng(48);
+  run<Map<int, int>, std::map<int, int>>(rng);
+  run<MultiMap<int, int>, std::multimap<int, int>>(rng);
+  run<HashedMap<int, int>, std::map<int, int>>(rng);
+  run<SmallMap<int, int, 8>, std::map<int, int>>(rng);
+  run<AugmentedMap<int, int, Sum>, std::map<int, int>>(rng);
+  run<AvlMap<int, int>, std::map<int, int>>(rng);
+  run<TreapMap<int, int>, std::map<int, int>>(rng);
+  run<SplayMap<int, int>, std::map<int, int>>(rng);
+
+  Set<int> s;
+  std::set<int> rs;
+  for (int i = 0; i < 10000; ++i) {
+    const int k = i % 100 ? i : i / 2;
+    CHECK(s.push_back(k).second == rs.insert(k).second);
+    if (i % 7 == 0) {
+      s.pop_front(3);
+      rs.erase(rs.begin(), std::next(rs.begin(), std::min<int>(3, rs.size())));
+    }
+  }
+  CHECK(s.verify() && std::equal(s.begin(), s.end(), rs.begin(), rs.end()));
+}
@@ -0,0 +1,186 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+// Throws from its copy constructor while failing is set.
+struct Fragile {
+  static inline bool failing = false;
+  int key;
+
+  Fragile(int key) : key(key) {}
+  Fragile(const Fragile& other) : key(other.key) {
+    if (failing)
+      throw std::runtime_error("copy");
+  }
+  Fragile& operator=(const Fragile&) = default;
+  bool operator<(const Fragile& other) const {
+    return key < other.key;
+  }
+};
+
+template <class Container, class Reference, class Make>
+void run(std::mt19937& rng, int span, Make make) {
+  Container c;
+  Reference r;
+  for (int step = 0; step < 20000; ++step) {
+    const auto k = make(rng() % span);
+    switch (rng() % 8) {
+    case 0:
+    case 1:
+    case 2:
+      c.insert(k);
+      r.insert(k);
+      break;
+    case 3:
+      CHECK(c.erase(k) == r.erase(k));
+      break;
+    case 4: {
+      const auto first = c.lower_bound(k);
+      const auto last = c.upper_bound(make(rng() % span));
+      if (first != c.end() && (last == c.end() || !(*last < *first))) {
+        r.erase(r.lower_bound(*first),
+                last == c.end() ? r.end() : r.lower_bound(*last));
+        c.erase(first, last);
+      }
+      break;
+    }
+    case 5: {
+      const auto it = c.find(k);
+      CHECK((it == c.end()) == !r.count(k));
+      if (it != c.end()) {
+        c.erase(it);
+        r.erase(r.find(k));
+      }
+      break;
+    }
+    case 6: {
+      CHECK(c.count(k) == r.count(k));
+      const auto [first, last] = c.equal_range(k);
+      CHECK(std::size_t(std::distance(first, last)) == r.count(k));
+      c.insert(c.end(), k);
+      r.insert(r.end(), k);
+      break;
+    }
+    default:
+      if (rng() % 50 == 0) {
+        c.clear();
+        r.clear();
+      } else {
+        Container copy(c);
+        Container moved(std::move(copy));
+        c = std::move(moved);
+      }
+    }
+    CHECK(c.size() == r.size() && c.verify());
+    CHECK(std::equal(c.begin(), c.end(), r.begin(), r.end()));
+    CHECK(std::equal(c.rbegin(), c.rend(), r.rbegin(), r.rend()));
+  }
+}
+
+struct Sum {
+  using value_type = long;
+  static long identity() {
+    return 0;
+  }
+  static long lift(int v) {
+    return v;
+  }
+  static long combine(long a, long b) {
+    return a + b;
+  }
+};
+
+int main() {
+  std::mt19937 rng(33);
+  const auto as_int = [](int x) { return x; };
+  const auto as_string = [](int x) {
+    return std::string(x % 3 ? 3 : 20, char('a' + x % 26)) +
+           std::to_string(x);
+  };
+  // Spans below, around and above the inline capacity.
+  for (int span : {6, 12, 30}) {
+    run<SmallSet<int, 8>, std::set<int>>(rng, span, as_int);
+    run<SmallSet<std::string, 4>, std::set<std::string>>(rng, span,
+                                                         as_string);
+    run<BasicSet<int, std::less<int>, false, NoAugment, RedBlack, 8>,
+        std::multiset<int>>(rng, span, as_int);
+    run<BasicSet<int, std::less<int>, true, NoAugment, Avl, 8>,
+        std::set<int>>(rng, span, as_int);
+    run<BasicSet<int, std::less<int>, true, NoAugment, Treap, 8>,
+        std::set<int>>(rng, span, as_int);
+    run<BasicSet<int, std::less<int>, true, NoAugment, Splay, 8>,
+        std::set<int>>(rng, span, as_int);
+  }
+
+  SmallMap<std::string, std::string, 4> m;
+  std::map<std::string, std::string> r;
+  for (int step = 0; step < 20000; ++step) {
+    const std::string k = as_string(rng() % 10);
+    switch (rng() % 4) {
+    case 0:
+      m.insert({k, k});
+      r.insert({k, k});
+      break;
+    case 1:
+      m[k] += "x";
+      r[k] += "x";
+      break;
+    case 2:
+      m.erase(k);
+      r.erase(k);
+      break;
+    default:
+      if (rng() % 20 == 0) {
+        m.clear();
+        r.clear();
+      }
+    }
+    CHECK(m.verify() && std::equal(m.begin(), m.end(), r.begin(), r.end()));
+  }
+
+  BasicSet<int, std::less<int>, true, Sum, RedBlack, 8> s;
+  std::set<int> rs;
+  for (int step = 0; step < 20000; ++step) {
+    const int k = rng() % 12;
+    if (rng() % 2) {
+      s.insert(k);
+      rs.insert(k);
+    } else {
+      s.erase(k);
+      rs.erase(k);
+    }
+    long total = 0;
+    for (int v : rs)
+      total += v;
+    CHECK(s.aggregate() == total && s.verify());
+  }
+
+  // A copy assignment that throws leaves the target as it was when either
+  // side is inline. Between two heap trees nodes are recycled in place, as
+  // in std::set, so only the basic guarantee holds there.
+  for (int target : {3, 20})
+    for (int source : {2, 5, 30}) {
+      if (target > 8 && source > 8)
+        continue;
+      SmallSet<Fragile, 8> a, b;
+      for (int i = 0; i < target; ++i)
+        a.insert(i);
+      for (int i = 0; i < source; ++i)
+        b.insert(100 + i);
+      Fragile::failing = true;
+      bool thrown = false;
+      try {
+        a = b;
+      } catch (const std::runtime_error&) {
+        thrown = true;
+      }
+      Fragile::failing = false;
+      CHECK(thrown && a.verify() && a.size() == std::size_t(target) &&
+            a.begin()->key == 0);
+    }
+}
@@ -0,0 +1,70 @@
+#include "Check.hpp"
+#include "StaticMap.hpp"
+#include <functional>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+constexpr auto codes = make_static_map<int, std::string_view>(
+    {{404, "Not Found"}, {200, "OK"}, {500, "Error"}, {301, "Moved"},
+     {200, "Duplicate"}});
+static_assert(codes.size() == 4 && codes.at(200) == "OK");
+static_assert(codes.begin()->first == 200 && (codes.end() - 1)->first == 500);
+static_assert(codes.find(302) == codes.end() && codes.count(1) == 0);
+static_assert(codes.lower_bound(300)->first == 301);
+static_assert(codes.upper_bound(301)->first == 404 && codes.contains(500));
+
+constexpr StaticMap<std::string_view, int, 3> config{
+    {"timeout", 30}, {"retries", 3}, {"port", 8080}};
+static_assert(config.at("port") == 8080 && config.begin()->first == "port");
+
+constexpr StaticMap<int, int, 3, std::greater<int>> descending{
+    {1, 1}, {3, 3}, {2, 2}};
+static_assert(descending.begin()->first == 3);
+static_assert(descending.find(2)->second == 2);
+
+constexpr StaticMap<int, int, 0> none{};
+static_assert(none.empty() && none.find(1) == none.end());
+
+template <class A, class B>
+bool same(const A& a, const B& b) {
+  return a.first == b.first && a.second == b.second;
+}
+
+int main() {
+  std::mt19937 rng(45);
+  for (int round = 0; round < 100; ++round) {
+    std::pair<int, int> raw[64];
+    std::map<int, int> r;
+    for (auto& p : raw) {
+      p = {int(rng() % 100), int(rng())};
+      r.insert(p);
+    }
+    const StaticMap<int, int, 64> m(raw);
+    CHECK(m.size() == r.size());
+    CHECK(std::equal(m.begin(), m.end(), r.begin(), r.end(),
+                     same<std::pair<int, int>, std::pair<const int, int>>));
+    CHECK(std::equal(m.rbegin(), m.rend(), r.rbegin(), r.rend(),
+                     same<std::pair<int, int>, std::pair<const int, int>>));
+    for (int k = -1; k < 101; ++k) {
+      const auto lb = m.lower_bound(k);
+      const auto rlb = r.lower_bound(k);
+      CHECK(lb == m.end() ? rlb == r.end() : same(*lb, *rlb));
+      const auto ub = m.upper_bound(k);
+      const auto rub = r.upper_bound(k);
+      CHECK(ub == m.end() ? rub == r.end() : same(*ub, *rub));
+      CHECK((m.find(k) == m.end()) == !r.count(k));
+      const auto [first, last] = m.equal_range(k);
+      CHECK(last - first == std::ptrdiff_t(r.count(k)));
+    }
+  }
+
+  bool thrown = false;
+  try {
+    StaticMap<int, int, 2> overflow{{1, 1}, {2, 2}, {3, 3}};
+  } catch (const std::length_error&) {
+    thrown = true;
+  }
+  CHECK(thrown);
+}
@@ -0,0 +1,60 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+
+int main() {
+  std::mt19937 rng(32);
+  // Short alphabets, embedded NULs and shared prefixes longer than the
+  // 8-byte cache all force the comparison past the cached prefix.
+  const auto make = [&] {
+    std::string s(rng() % 3 ? 0 : 12, 'p');
+    for (int n = rng() % 14; n > 0; --n)
+      s += "ab\0c"[rng() % 4];
+    return s;
+  };
+  Map<std::string, int, std::less<>> m;
+  std::map<std::string, int, std::less<>> r;
+  MultiSet<std::string> ms;
+  std::multiset<std::string> rms;
+  for (int step = 0; step < 50000; ++step) {
+    const std::string k = make();
+    const std::string_view view = k;
+    switch (rng() % 4) {
+    case 0:
+      CHECK(m.insert({k, step}).second == r.insert({k, step}).second);
+      ms.insert(k);
+      rms.insert(k);
+      break;
+    case 1:
+      CHECK(m.erase(k) == r.erase(k));
+      CHECK(ms.erase(k) == rms.erase(k));
+      break;
+    default: {
+      CHECK((m.find(view) == m.end()) == (r.find(view) == r.end()));
+      CHECK(m.count(view) == r.count(view));
+      const auto lb = m.lower_bound(view);
+      const auto rlb = r.lower_bound(view);
+      CHECK(lb == m.end() ? rlb == r.end() : lb->first == rlb->first);
+      const auto ub = m.upper_bound(view);
+      const auto rub = r.upper_bound(view);
+      CHECK(ub == m.end() ? rub == r.end() : ub->first == rub->first);
+      CHECK(ms.count(k) == rms.count(k));
+    }
+    }
+    if (step % 5000 == 0)
+      CHECK(m.verify() && ms.verify());
+  }
+  CHECK(std::equal(m.begin(), m.end(), r.begin(), r.end()));
+  CHECK(std::equal(ms.begin(), ms.end(), rms.begin(), rms.end()));
+
+  auto copy = m;
+  copy[std::string("ab\0", 3)] = 1;
+  copy["ab"] = 2;
+  CHECK(copy.verify() && copy.find("ab")->second == 2);
+  CHECK(copy.find(std::string_view("ab\0", 3))->second == 1);
+}
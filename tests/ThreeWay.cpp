@@ -0,0 +1,76 @@
+#include "Check.hpp"
+#include "Map.hpp"
+#include "Set.hpp"
+#include <compare>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+// Orders by descending key through compare(), the three-way entry point.
+struct Descending {
+  bool operator()(int a, int b) const {
+    return a > b;
+  }
+  std::strong_ordering compare(int a, int b) const {
+    return b <=> a;
+  }
+};
+
+template <class Container, class Reference, class Key>
+void run(std::mt19937& rng, Key (*make)(int)) {
+  Container c;
+  Reference r;
+  for (int step = 0; step < 40000; ++step) {
+    const Key k = make(rng() % 600);
+    switch (rng() % 6) {
+    case 0:
+    case 1: {
+      const auto it = c.insert(k);
+      const auto rt = r.insert(k);
+      if constexpr (requires { it.second; })
+        CHECK(it.second == rt.second && *it.first == *rt.first);
+      else
+        CHECK(*it == *rt);
+      break;
+    }
+    case 2:
+      CHECK(c.erase(k) == r.erase(k));
+      break;
+    default: {
+      const auto it = c.find(k);
+      CHECK(it == c.end() ? !r.count(k) : *it == k);
+      CHECK(c.count(k) == r.count(k));
+      const auto [first, last] = c.equal_range(k);
+      const auto [rfirst, rlast] = r.equal_range(k);
+      CHECK(std::distance(first, last) == std::distance(rfirst, rlast));
+      CHECK(first == c.lower_bound(k) && last == c.upper_bound(k));
+      CHECK(last == c.end() ? rlast == r.end() : *last == *rlast);
+    }
+    }
+  }
+  CHECK(c.verify() && std::equal(c.begin(), c.end(), r.begin(), r.end()));
+}
+
+int to_int(int i) {
+  return i;
+}
+
+std::string to_string(int i) {
+  return "key/" + std::to_string(i);
+}
+
+int main() {
+  std::mt19937 rng(31);
+  run<Set<int, Descending>, std::set<int, Descending>>(rng, to_int);
+  run<MultiSet<int, Descending>, std::multiset<int, Descending>>(rng, to_int);
+  run<Set<std::string>, std::set<std::string>>(rng, to_string);
+  run<MultiSet<std::string, std::less<>>, std::multiset<std::string>>(
+      rng, to_string);
+
+  Map<std::string, int, std::less<>> m;
+  m["b"] = 2;
+  m["a"] = 1;
+  CHECK(m.find("a")->second == 1 && m.count("c") == 0);
+  CHECK(!m.insert({"b", 3}).second && m.at("b") == 2 && m.verify());
+}